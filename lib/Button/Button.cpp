@@ -1,3 +1,10 @@
+/**
+ * Button Library
+ * Push button with press and release callbacks. Debouncing is done for all buttons at once 
+ * by an Input_Scanner, which calls update() when a button's debounced state changes. Edges 
+ * are also captured by a pin change interrupt and timestamped there, which also catches 
+ * taps the scanner's samples miss.
+ **/
 #include "Button.h"
 
 /**
@@ -12,20 +19,125 @@ Button::Button(uint8_t pin_in, bool internal_pullup){
 }
 
 /**
- * Check button status (run every loop)
+ * Start timestamping edges with the pin change interrupt
+ **/
+void Button::begin(){
+#ifndef SIMULATE
+    attachInterruptArg(digitalPinToInterrupt(pin), edge, this, CHANGE);
+#endif
+}
+
+/**
+ * Stop timestamping edges (changes are then reported at the time they are debounced)
+ **/
+void Button::end(){
+#ifndef SIMULATE
+    detachInterrupt(digitalPinToInterrupt(pin));
+#endif
+}
+
+/**
+ * Set the debounced state and run callbacks (called by the input scanner)
+ * @param pressed new state
+ **/
+void Button::update(bool pressed){
+    if(pressed == current_state) return;
+    current_state = pressed;
+
+    if(pressed){
+        press_time = edge_time(true);
+        if(posedge_cb != NULL) posedge_cb();
+    }else{
+        release_time = edge_time(false);
+        if(tapped) release_time = tap_release;
+        tapped = false;
+        if(negedge_cb != NULL) negedge_cb();
+    }
+}
+
+/**
+ * Look for a whole press in the queued edges, for a tap that started and ended between two
+ * samples of the input scanner (e.g. while the loop was stalled). If there is one, the 
+ * button is pressed with the time of the tap, and the next update() releases it with the 
+ * time the tap ended.
+ * @param min_time shortest press that counts, so bounces and glitches don't (us)
+ * @return true if a tap was found and the button pressed
  **/
-void Button::handle(){
-    bool new_state = !digitalRead(pin);
-    if(new_state != current_state && millis() > last_change + DEBOUNCE_TIME){
-        current_state = new_state;
-        last_change = millis();
-        if(new_state){
-            if(posedge_cb != NULL) posedge_cb();
+bool Button::tap(uint32_t min_time){
+    if(current_state || queue_tail == queue_head) return false;
+
+    uint8_t head = queue_head;
+    uint32_t last_edge = 0;
+    uint32_t press = 0;
+    bool pressing = false;
+    bool found = false;
+    for(uint8_t i = queue_tail; i != head; i = (i + 1) % BUTTON_QUEUE_SIZE){
+        const Edge& next = queue[i];
+        bool settled = i == queue_tail || next.time - last_edge >= BUTTON_SETTLE_TIME;
+        last_edge = next.time;
+        if(next.pressed){
+            if(settled || !pressing) press = next.time;
+            pressing = true;
+        }else if(pressing && next.time - press >= min_time){
+            tap_release = next.time;
+            found = true;
+            break;
         }
-        if(!new_state){
-            if(negedge_cb != NULL) negedge_cb();
+    }
+
+    // Edges that made no tap are only bounces or glitches once they've settled
+    if(!found){
+        if(clock_micros() - last_edge >= BUTTON_SETTLE_TIME) queue_tail = head;
+        return false;
+    }
+
+    queue_tail = head;
+    current_state = true;
+    tapped = true;
+    press_time = press;
+    if(posedge_cb != NULL) posedge_cb();
+    return true;
+}
+
+/**
+ * Find when a debounced change started and clear the queued edges
+ * @param pressed new state
+ * @return time of the first edge to the new state after the last quiet period, or now if 
+ *  there is none (us, as clock_micros())
+ **/
+uint32_t Button::edge_time(bool pressed){
+    uint32_t time = clock_micros();
+    bool found = false;
+    uint32_t last_edge = 0;
+    bool first = true;
+    while(queue_tail != queue_head){
+        const Edge& next = queue[queue_tail];
+        bool settled = first || next.time - last_edge >= BUTTON_SETTLE_TIME;
+        if(next.pressed == pressed && (!found || settled)){
+            time = next.time;
+            found = true;
         }
+        last_edge = next.time;
+        first = false;
+        queue_tail = (queue_tail + 1) % BUTTON_QUEUE_SIZE;
+    }
+    return time;
+}
+
+/**
+ * Pin change interrupt: queue the edge with its time
+ * @param arg Button the pin belongs to
+ **/
+void IRAM_ATTR Button::edge(void* arg){
+    Button* button = (Button*)arg;
+    uint8_t head = button->queue_head;
+    uint8_t next = (head + 1) % BUTTON_QUEUE_SIZE;
+    if(next == button->queue_tail){
+        button->overflows++;
+        return;
     }
+    button->queue[head] = {micros(), !GPIP(button->pin)};
+    button->queue_head = next;
 }
 
 /**
@@ -50,4 +162,61 @@ void Button::set_negedge_cb(void_function_pointer negedge_cb_in){
  **/
 bool Button::get(){
     return current_state;
-}
\ No newline at end of file
+}
+
+/**
+ * @return true if the button is pressed right now (not debounced)
+ **/
+bool Button::read(){
+#ifdef SIMULATE
+    return injected;
+#else
+    return !digitalRead(pin);
+#endif
+}
+
+/**
+ * @return GPIO number of button
+ **/
+uint8_t Button::get_pin(){
+    return pin;
+}
+
+/**
+ * @return when the button was last pressed, as timestamped by the interrupt 
+ *  (us, as clock_micros())
+ **/
+uint32_t Button::get_press_time(){
+    return press_time;
+}
+
+/**
+ * @return when the button was last released, as timestamped by the interrupt 
+ *  (us, as clock_micros())
+ **/
+uint32_t Button::get_release_time(){
+    return release_time;
+}
+
+/**
+ * @return edges dropped because the queue was full
+ **/
+uint32_t Button::get_overflows(){
+    return overflows;
+}
+
+#ifdef SIMULATE
+/**
+ * Simulate the button state in place of the pin
+ * @param pressed (TRUE = pressed, FALSE = not pressed)
+ **/
+void Button::inject(bool pressed){
+    if(pressed == injected) return;
+    injected = pressed;
+
+    uint8_t next = (queue_head + 1) % BUTTON_QUEUE_SIZE;
+    if(next == queue_tail) return;
+    queue[queue_head] = {clock_micros(), pressed};
+    queue_head = next;
+}
+#endif
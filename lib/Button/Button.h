@@ -1,9 +1,22 @@
+/**
+ * Button Library
+ * Push button with press and release callbacks. Debouncing is done for all buttons at once 
+ * by an Input_Scanner, which calls update() when a button's debounced state changes. Edges 
+ * are also captured by a pin change interrupt and timestamped there, so each press and 
+ * release is reported at the time it actually happened, and a tap that starts and ends 
+ * while the loop is stalled is still found in them (see tap()).
+ * 
+ * Run begin() once to start timestamping edges.
+ **/
 #include "Arduino.h"
+#include "Clock.h"
 
 typedef void (*void_function_pointer)();
 
-// Time to wait for button input to settle
-#define DEBOUNCE_TIME 50
+// Edges the interrupt can queue between debounced changes
+#define BUTTON_QUEUE_SIZE 16
+// Quiet time before an edge for it to count as the start of a change, not a bounce (us)
+#define BUTTON_SETTLE_TIME 10000
 
 class Button{
 
@@ -12,17 +25,51 @@ class Button{
         Button(uint8_t pin_in, bool internal_pullup);
 
         void 
-            handle(),
+            begin(),
+            end(),
+            update(bool pressed),
             set_posedge_cb(void_function_pointer),
             set_negedge_cb(void_function_pointer);
         
         bool get();
+        bool read();
+        bool tap(uint32_t min_time);
+        uint8_t get_pin();
+
+        uint32_t
+            get_press_time(),
+            get_release_time(),
+            get_overflows();
+
+#ifdef SIMULATE
+        void inject(bool pressed);
+#endif
 
     private:
 
+        struct Edge{
+            uint32_t time;      // (us, as clock_micros())
+            bool pressed;
+        };
+
         bool current_state = false;
         uint8_t pin;
         void_function_pointer posedge_cb = NULL;
         void_function_pointer negedge_cb = NULL;
-        uint64_t last_change = 0;
-};
\ No newline at end of file
+        uint32_t press_time = 0;
+        uint32_t release_time = 0;
+        uint32_t tap_release = 0;   // Release time of a tap found by tap(), until update()
+        bool tapped = false;
+
+        Edge queue[BUTTON_QUEUE_SIZE];
+        volatile uint8_t queue_head = 0;
+        volatile uint8_t queue_tail = 0;
+        volatile uint32_t overflows = 0;
+
+        uint32_t edge_time(bool pressed);
+        static void edge(void* arg);
+
+#ifdef SIMULATE
+        bool injected = false;
+#endif
+};
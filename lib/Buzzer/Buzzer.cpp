@@ -1,10 +1,15 @@
 /**
  * Buzzer Library
- * Control an externally connected buzzer
- * 
- * Run the handle() function on each loop or as often as possible for correct timing.
+ * Control an externally connected buzzer. Sounds are played from patterns of steps (tone, 
+ * on time, gap, repeats), usually kept in PROGMEM.
  **/
 #include "Buzzer.h"
+#include "Scheduler.h"
+#include "core_esp8266_waveform.h"
+
+// Starts the next repeat of the pattern playing
+Soft_Timer step_timer;
+Buzzer* buzzer_playing = NULL;
 
 /**
  * Constructor
@@ -17,32 +22,98 @@ Buzzer::Buzzer(uint8_t pin, bool buzzer_on){
 
     pinMode(_pin, OUTPUT);
     digitalWrite(_pin, LOW);
-    _double = false;
-    _buzzer_active = false;
+    _steps[0].on = 0;
+    _started_at = 0;
+}
+
+/**
+ * Set buzzer on
+ * @param buzzer_on
+ **/
+void Buzzer::set_buzzer_on(bool buzzer_on){
+    _buzzer_on = buzzer_on;
+    if(!_buzzer_on) stop();
 }
 
 /**
- * Update buzzer status (run every loop)
+ * Play a pattern, replacing any that is playing
+ * @param pattern PROGMEM steps, ending with a step with no on time
  **/
-void Buzzer::handle(){
-    if(_buzzer_active && millis() >= _time_stop){
+void Buzzer::play(const Buzzer_Step* pattern){
+    if(!_buzzer_on) return;
+    stop();
+
+    uint8_t length = 0;
+    do{
+        memcpy_P(&_steps[length], &pattern[length], sizeof(Buzzer_Step));
+    }while(_steps[length].on != 0 && ++length < BUZZER_MAX_STEPS - 1);
+    _steps[length].on = 0;
+    start();
+}
+
+/**
+ * Stop the pattern playing
+ **/
+void Buzzer::stop(){
+    step_timer.remove();
+    stopWaveform(_pin);
+    digitalWrite(_pin, LOW);
+    _steps[0].on = 0;
+    _step = 0;
+    buzzer_playing = NULL;
+}
+
+/**
+ * Start playing the steps from the beginning
+ **/
+void Buzzer::start(){
+    _step = 0;
+    _repeat = 0;
+    _next = clock_millis();
+    _started_at = clock_micros();
+    buzzer_playing = this;
+    sound();
+}
+
+/**
+ * Start the current repeat of the current step, and set a timer for the next one
+ **/
+void Buzzer::sound(){
+    const Buzzer_Step& step = _steps[_step];
+    if(step.on == 0){
+        stopWaveform(_pin);
         digitalWrite(_pin, LOW);
-        _buzzer_active = false;
-        if(_double){
-            _time_stop = millis() + SHORT_BEEP_TIME;
-        }
-    }else if(_double && millis() >= _time_stop){
-        beep_short();
-        _double = false;
+        buzzer_playing = NULL;
+        return;
+    }
+
+    uint32_t period = step.on + step.gap;
+    if(step.frequency == 0){
+        // All repeats in one waveform: high for the on time, low for the gap
+        uint8_t repeats = step.repeat - _repeat;
+        startWaveform(_pin, step.on * 1000UL, max(step.gap, (uint16_t)1) * 1000UL, 
+            (repeats * period - step.gap) * 1000UL);
+        _next += repeats * period;
+        _repeat = step.repeat;
+    }else{
+        uint32_t half = 500000UL / step.frequency;
+        startWaveform(_pin, half, half, step.on * 1000UL);
+        _next += period;
+        _repeat++;
     }
+
+    if(_repeat >= step.repeat){
+        _step++;
+        _repeat = 0;
+    }
+    step_timer.set_timer_at(next_repeat, _next);
 }
 
 /**
- * Set buzzer on
- * @param buzzer_on
+ * Timer callback for the next repeat
  **/
-void Buzzer::set_buzzer_on(bool buzzer_on){
-    _buzzer_on = buzzer_on;
+void Buzzer::next_repeat(){
+    if(buzzer_playing != NULL) buzzer_playing->sound();
 }
 
 /**
@@ -50,24 +121,24 @@ void Buzzer::set_buzzer_on(bool buzzer_on){
  * @param time to beep (ms)
  **/
 void Buzzer::beep(uint16_t time) {
-    if(_buzzer_on) {
-        digitalWrite(_pin, HIGH);
-        _time_stop = millis() + time;
-        _buzzer_active = true;
-    }
+    if(!_buzzer_on || time == 0) return;
+    stop();
+    _steps[0] = {0, time, 0, 1};
+    _steps[1].on = 0;
+    start();
 }
 
 /**
- * Short beep
+ * @return true if a pattern is playing
  **/
-void Buzzer::beep_short() {
-    beep(100);
+bool Buzzer::playing(){
+    return buzzer_playing == this;
 }
 
 /**
- * Double short beep
+ * Get when the last pattern or beep started, for checking it against the display
+ * @return time (us, as clock_micros())
  **/
-void Buzzer::beep_double() {
-    beep_short();
-    _double = true;
-}
\ No newline at end of file
+uint32_t Buzzer::get_started_at(){
+    return _started_at;
+}
@@ -1,28 +1,53 @@
 /**
  * Buzzer Library
- * Control an externally connected buzzer
+ * Control an externally connected buzzer. Sounds are played from patterns of steps (tone, 
+ * on time, gap, repeats), usually kept in PROGMEM.
  * 
- * Run the handle() function on each loop or as often as possible for correct timing.
+ * Each tone is generated and ended by the core's waveform generator (timer1), so its length
+ * is exact whatever the loop is doing. Repeats of a plain (0 Hz) step are one waveform, so 
+ * their gaps are exact too. Other steps start from the scheduler at deadlines measured from 
+ * the start of the pattern, so a stalled loop can delay a step but never stretches one or 
+ * pushes back the rest.
+ * 
+ * Uses the global scheduler, so run scheduler.begin() and scheduler.handle().
  **/
 #include "Arduino.h"
+#include "Clock.h"
+
+// Most steps in a pattern
+#define BUZZER_MAX_STEPS 8
 
-#define SHORT_BEEP_TIME 100
+struct Buzzer_Step{
+    uint16_t frequency;     // Tone (Hz), 0 to drive the buzzer high (for active buzzers)
+    uint16_t on;            // Time sounding (ms), 0 ends the pattern
+    uint16_t gap;           // Quiet time after each repeat (ms)
+    uint8_t repeat;         // Times to play the step
+};
 
 class Buzzer{
     public:
         Buzzer(uint8_t pin, bool buzzer_on);
 
-        void handle();
-        void set_buzzer_on(bool buzze_on);
+        void set_buzzer_on(bool buzzer_on);
 
+        void play(const Buzzer_Step* pattern);
+        void stop();
         void beep(uint16_t time);
-        void beep_short();
-        void beep_double();
+
+        bool playing();
+        uint32_t get_started_at();
     private:
         uint8_t _pin;
         bool _buzzer_on;
 
-        bool _buzzer_active;
-        long _time_stop;
-        bool _double;
-};
\ No newline at end of file
+        // Pattern playing, copied out of PROGMEM
+        Buzzer_Step _steps[BUZZER_MAX_STEPS];
+        uint8_t _step;
+        uint8_t _repeat;
+        uint32_t _next;         // When the next repeat starts (ms, as clock_millis())
+        uint32_t _started_at;   // When the pattern started (us, as clock_micros())
+
+        static void next_repeat();
+        void start();
+        void sound();
+};
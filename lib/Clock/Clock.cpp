@@ -0,0 +1,93 @@
+/**
+ * Clock Library
+ * Time source for the timer sequence. Uses millis(), or a virtual time that only moves in 
+ * clock_yield(), clock_delay() and clock_advance() when built with -D SIMULATE.
+ **/
+#include "Clock.h"
+
+#ifdef SIMULATE
+
+uint32_t virtual_time = 0;
+clock_function idle_callback = NULL;
+
+/**
+ * @return virtual time (ms)
+ **/
+uint32_t clock_millis(){
+    return virtual_time;
+}
+
+/**
+ * @return virtual time (us, counts in whole ms)
+ **/
+uint32_t clock_micros(){
+    return virtual_time * 1000;
+}
+
+/**
+ * Wait inside a busy loop. Runs the idle callback, then moves virtual time forward by 1ms, so 
+ * the callback sees the time the wait started at first.
+ **/
+void clock_yield(){
+    yield();
+    if(idle_callback != NULL) idle_callback();
+    virtual_time++;
+}
+
+/**
+ * Wait without spinning. Moves virtual time forward 1ms at a time like clock_yield(), so the
+ * idle callback runs at every ms of the wait.
+ * @param time to wait (ms)
+ **/
+void clock_delay(uint32_t time){
+    for(uint32_t i = 0; i < time; i++) clock_yield();
+}
+
+/**
+ * Move virtual time forward
+ * @param time to move forward (ms)
+ **/
+void clock_advance(uint32_t time){
+    virtual_time += time;
+}
+
+/**
+ * Set the function to run when virtual time moves in clock_yield()
+ * @param callback void function to call
+ **/
+void clock_set_idle_callback(clock_function callback){
+    idle_callback = callback;
+}
+
+#else
+
+/**
+ * @return time since boot (ms)
+ **/
+uint32_t clock_millis(){
+    return millis();
+}
+
+/**
+ * @return time since boot (us)
+ **/
+uint32_t clock_micros(){
+    return micros();
+}
+
+/**
+ * Wait inside a busy loop
+ **/
+void clock_yield(){
+    yield();
+}
+
+/**
+ * Wait without spinning
+ * @param time to wait (ms)
+ **/
+void clock_delay(uint32_t time){
+    delay(time);
+}
+
+#endif
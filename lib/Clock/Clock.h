@@ -0,0 +1,18 @@
+/**
+ * Clock Library
+ * Time source for the timer sequence. Uses millis(), or a virtual time that only moves in 
+ * clock_yield(), clock_delay() and clock_advance() when built with -D SIMULATE.
+ **/
+#include "Arduino.h"
+
+typedef void (*clock_function)();
+
+uint32_t clock_millis();
+uint32_t clock_micros();
+void clock_yield();
+void clock_delay(uint32_t time);
+
+#ifdef SIMULATE
+void clock_advance(uint32_t time);
+void clock_set_idle_callback(clock_function callback);
+#endif
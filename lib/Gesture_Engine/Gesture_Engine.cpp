@@ -0,0 +1,124 @@
+/**
+ * Gesture Engine Library
+ * Turns the debounced button states of an Input_Scanner into tap, hold, long press and 
+ * chord events, without blocking the loop.
+ * 
+ * Run the handle() function on each loop, right after the scanner's handle().
+ **/
+#include "Gesture_Engine.h"
+
+/**
+ * Constructor
+ * @param scanner that debounces the buttons
+ **/
+Gesture_Engine::Gesture_Engine(Input_Scanner& scanner) : _scanner(scanner){}
+
+/**
+ * Send gestures for any changes since the last call (run every loop)
+ **/
+void Gesture_Engine::handle(){
+    uint16_t state = _scanner.get_state();
+    uint16_t pressed = state & ~last_state;
+    uint16_t released = ~state & last_state;
+    last_state = state;
+    uint32_t now = clock_millis();
+
+    for(uint8_t pin = 0; pin < 16; pin++){
+        uint16_t bit = 1 << pin;
+
+        if(released & bit){
+            if(!(done & bit)) emit(GESTURE_TAP, pin);
+            done &= ~bit;
+        }
+
+        if(pressed & bit){
+            press_time[pin] = now;
+            done &= ~bit;
+
+            // A press while a modifier is held is a chord, and uses up both presses
+            uint16_t held = state & modifiers & ~bit;
+            if(!(modifiers & bit) && held){
+                uint8_t modifier = __builtin_ctz(held);
+                done |= bit | held;
+                emit(GESTURE_CHORD, pin, modifier);
+            }else{
+                emit(GESTURE_PRESS, pin);
+            }
+        }
+    }
+
+    // Holds that are still being counted
+    uint16_t holding = state & ~done;
+    if(holding == 0) return;
+    bool report = now - last_hold >= GESTURE_HOLD_INTERVAL;
+    for(uint8_t pin = 0; pin < 16; pin++){
+        uint16_t bit = 1 << pin;
+        if(!(holding & bit)) continue;
+
+        uint32_t elapsed = now - press_time[pin];
+        if(elapsed >= long_time){
+            done |= bit;
+            emit(GESTURE_LONG_PRESS, pin);
+        }else if(elapsed >= GESTURE_HOLD_DELAY && report){
+            last_hold = now;
+            emit(GESTURE_HOLD, pin, 0, elapsed * 1000 / long_time);
+        }
+    }
+}
+
+/**
+ * Get the time until a hold needs reporting
+ * @return time (ms), UINT32_MAX if no holds are being counted
+ **/
+uint32_t Gesture_Engine::time_to_next(){
+    uint16_t holding = last_state & ~done;
+    if(holding == 0) return UINT32_MAX;
+    uint32_t now = clock_millis();
+    int32_t left = last_hold + GESTURE_HOLD_INTERVAL - now;
+    return left > 0 ? left : 0;
+}
+
+/**
+ * Send a gesture to the callback
+ * @param type of gesture
+ * @param pin of button
+ * @param modifier pin held (chord only)
+ * @param progress towards a long press (hold only, per mille)
+ **/
+void Gesture_Engine::emit(Gesture_Type type, uint8_t pin, uint8_t modifier, uint16_t progress){
+    if(callback == NULL) return;
+    callback({type, pin, modifier, progress, press_time[pin]});
+}
+
+/**
+ * Set the function to send gestures to
+ * @param callback_in function to call with each gesture
+ **/
+void Gesture_Engine::set_callback(gesture_function callback_in){
+    callback = callback_in;
+}
+
+/**
+ * Set the time for a long press
+ * @param time (ms)
+ **/
+void Gesture_Engine::set_long_time(uint16_t time){
+    long_time = time;
+}
+
+/**
+ * Set which buttons make chords when held while another is pressed
+ * @param pins bit set for each modifier GPIO
+ **/
+void Gesture_Engine::set_modifiers(uint16_t pins){
+    modifiers = pins;
+}
+
+/**
+ * Send nothing more for presses in progress until they are released (no tap, hold or long
+ * press), e.g. when the press has already been acted on
+ * @param pins bit set for each GPIO
+ **/
+void Gesture_Engine::suppress(uint16_t pins){
+    done |= pins & last_state;
+}
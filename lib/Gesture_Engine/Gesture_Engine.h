@@ -0,0 +1,72 @@
+/**
+ * Gesture Engine Library
+ * Turns the debounced button states of an Input_Scanner into gesture events, without 
+ * blocking the loop:
+ *  -Press: a button goes down (sent straight away)
+ *  -Tap: a button is released before the long press time
+ *  -Hold: a button is still down, with progress towards a long press
+ *  -Long press: a button has been down for the long press time (sent once, while held)
+ *  -Chord: a button goes down while a modifier button is held (sent instead of a press)
+ * 
+ * Once a press has been used for a chord or long press, or suppressed, it sends nothing more 
+ * until it's released.
+ * 
+ * Run the handle() function on each loop, right after the scanner's handle().
+ **/
+#include "Arduino.h"
+#include "Input_Scanner.h"
+
+// Default time for a long press (ms)
+#define GESTURE_LONG_TIME 1000
+// Time before a hold starts reporting progress, so taps don't (ms)
+#define GESTURE_HOLD_DELAY 250
+// Time between hold progress events (ms)
+#define GESTURE_HOLD_INTERVAL 50
+
+typedef enum {
+    GESTURE_PRESS       = 0,
+    GESTURE_TAP         = 1,
+    GESTURE_HOLD        = 2,
+    GESTURE_LONG_PRESS  = 3,
+    GESTURE_CHORD       = 4
+} Gesture_Type;
+
+struct Gesture{
+    Gesture_Type type;
+    uint8_t pin;            // GPIO of the button
+    uint8_t modifier;       // GPIO of the modifier held (chord only)
+    uint16_t progress;      // Progress towards a long press (hold only, per mille)
+    uint32_t time;          // When the button went down (ms, as clock_millis())
+};
+
+typedef void (*gesture_function)(const Gesture& gesture);
+
+class Gesture_Engine{
+
+    public:
+
+        Gesture_Engine(Input_Scanner& scanner);
+
+        void 
+            handle(),
+            set_callback(gesture_function),
+            set_long_time(uint16_t),
+            set_modifiers(uint16_t),
+            suppress(uint16_t);
+
+        uint32_t time_to_next();
+
+    private:
+
+        Input_Scanner& _scanner;
+        gesture_function callback = NULL;
+        uint16_t long_time = GESTURE_LONG_TIME;
+        uint16_t modifiers = 0;     // Pins that make chords
+
+        uint16_t last_state = 0;
+        uint16_t done = 0;          // Pins whose press sends nothing more until released
+        uint32_t press_time[16];
+        uint32_t last_hold = 0;
+
+        void emit(Gesture_Type type, uint8_t pin, uint8_t modifier = 0, uint16_t progress = 0);
+};
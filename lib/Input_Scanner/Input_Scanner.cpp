@@ -0,0 +1,119 @@
+/**
+ * Input Scanner Library
+ * Debounces all buttons at once with a vertical counter on a single read of the GPIO input
+ * register per tick, plus the taps in the buttons' edge queues that fell between ticks.
+ * 
+ * Run the handle() function on each loop or as often as possible.
+ **/
+#include "Input_Scanner.h"
+
+/**
+ * Add a button to scan
+ * @param button on GPIO 0-15
+ **/
+void Input_Scanner::add(Button& button){
+    if(num_buttons >= SCANNER_MAX_BUTTONS || button.get_pin() > 15) return;
+    buttons[num_buttons++] = &button;
+    mask |= 1 << button.get_pin();
+}
+
+/**
+ * Sample and debounce all buttons once per tick, and update buttons that changed (run every
+ * loop)
+ **/
+void Input_Scanner::handle(){
+    uint32_t now = clock_micros();
+    if(now - last_tick < SCANNER_TICK_TIME) return;
+    last_tick = now;
+
+    // Count ticks where the sample differs from the state, reset the count where it agrees
+    uint16_t delta = sample() ^ state;
+    count_1 = (count_1 ^ count_0) & delta;
+    count_0 = ~count_0 & delta;
+
+    // Pins whose count rolled over (4 ticks in a row) change state, and taps pressed on the 
+    // last tick are released
+    uint16_t toggle = (delta & ~(count_0 | count_1)) | tapped;
+    count_0 &= ~tapped;
+    count_1 &= ~tapped;
+    state ^= toggle;
+    pressed = toggle & state;
+    released = toggle & ~state;
+
+    for(uint8_t i = 0; i < num_buttons; i++){
+        uint16_t bit = 1 << buttons[i]->get_pin();
+        if(toggle & bit) buttons[i]->update(state & bit);
+    }
+
+    // Taps that were over before they could be sampled (the button presses itself)
+    uint16_t quiet = ~(state | delta | tapped) & mask;
+    tapped = 0;
+    if(quiet == 0) return;
+    for(uint8_t i = 0; i < num_buttons; i++){
+        uint16_t bit = 1 << buttons[i]->get_pin();
+        if((quiet & bit) && buttons[i]->tap(SCANNER_MIN_TAP)) tapped |= bit;
+    }
+    state |= tapped;
+    pressed |= tapped;
+}
+
+/**
+ * Read all button pins at once
+ * @return bit set for each pressed pin (buttons to GND)
+ **/
+uint16_t Input_Scanner::sample(){
+#ifdef SIMULATE
+    uint16_t pins = 0;
+    for(uint8_t i = 0; i < num_buttons; i++){
+        if(buttons[i]->read()) pins |= 1 << buttons[i]->get_pin();
+    }
+    return pins;
+#else
+    return ~GPI & mask;
+#endif
+}
+
+/**
+ * @return debounced state of all pins (bit set = pressed)
+ **/
+uint16_t Input_Scanner::get_state(){
+    return state;
+}
+
+/**
+ * @return pins pressed on the last tick
+ **/
+uint16_t Input_Scanner::get_pressed(){
+    return pressed;
+}
+
+/**
+ * @return pins released on the last tick
+ **/
+uint16_t Input_Scanner::get_released(){
+    return released;
+}
+
+/**
+ * @return pins that changed on the last tick
+ **/
+uint16_t Input_Scanner::get_changed(){
+    return pressed | released;
+}
+
+/**
+ * Check if all buttons are released and settled, so a press would be a new event
+ * @return true if nothing is pressed or counting towards a change
+ **/
+bool Input_Scanner::idle(){
+    return state == 0 && (count_0 | count_1) == 0 && sample() == 0;
+}
+
+/**
+ * @return time until the next tick (ms), or UINT32_MAX if idle
+ **/
+uint32_t Input_Scanner::time_to_next(){
+    if(idle()) return UINT32_MAX;
+    int32_t left = last_tick + SCANNER_TICK_TIME - clock_micros();
+    return left > 0 ? left / 1000 : 0;
+}
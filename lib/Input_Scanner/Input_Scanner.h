@@ -0,0 +1,59 @@
+/**
+ * Input Scanner Library
+ * Debounces all buttons at once. Every tick the GPIO input register is read once and each 
+ * pin is run through a 2-bit vertical counter, so a pin only changes state after 4 ticks in 
+ * a row that disagree with it. The work per tick is the same however many buttons there are.
+ * 
+ * Buttons are updated (and their callbacks run) when their debounced state changes.
+ * 
+ * A tap that starts and ends between two ticks (while the loop is stalled, e.g. by a flash 
+ * write or a bit-banged display) never shows up in a sample, so the buttons' queued edges 
+ * are checked as well: a press of at least SCANNER_MIN_TAP found there is pressed on that 
+ * tick and released on the next, as if the counter had seen it.
+ * 
+ * Run the handle() function on each loop or as often as possible.
+ **/
+#include "Arduino.h"
+#include "Clock.h"
+#include "Button.h"
+
+// Maximum number of buttons (one per GPIO 0-15)
+#define SCANNER_MAX_BUTTONS 16
+// Time between samples (us). A change is accepted after 4 samples.
+#define SCANNER_TICK_TIME 2000
+// Shortest press found in the queued edges that counts as a tap (us), the same as the counter
+#define SCANNER_MIN_TAP (SCANNER_TICK_TIME * 4)
+
+class Input_Scanner{
+
+    public:
+
+        void add(Button& button);
+        void handle();
+
+        uint16_t
+            get_state(),
+            get_pressed(),
+            get_released(),
+            get_changed();
+
+        bool idle();
+        uint32_t time_to_next();
+
+    private:
+
+        Button* buttons[SCANNER_MAX_BUTTONS];
+        uint8_t num_buttons = 0;
+        uint16_t mask = 0;          // Pins of all buttons
+        
+        uint16_t state = 0;         // Debounced state (bit set = pressed)
+        uint16_t count_0 = 0;       // Low bit of the counter of each pin
+        uint16_t count_1 = 0;       // High bit of the counter of each pin
+        uint16_t pressed = 0;       // Pins pressed on the last tick
+        uint16_t released = 0;      // Pins released on the last tick
+        uint16_t tapped = 0;        // Pins pressed from their queued edges, released next tick
+
+        uint32_t last_tick = 0;
+
+        uint16_t sample();
+};
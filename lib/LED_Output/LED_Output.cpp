@@ -0,0 +1,162 @@
+/**
+ * LED Output Library
+ * Output backends for WS2812 LED strips. Each backend clocks out the pixel buffer of an
+ * Adafruit_NeoPixel strip.
+ **/
+#include "LED_Output.h"
+
+/**
+ * UART byte for each pair of WS2812 bits (MSB first). With 6N1 framing and TX inverted,
+ * the start bit, 6 data bits (LSB first) and stop bit form two 1.25us WS2812 bit cells.
+ **/
+static const uint8_t uart_encoding[4] = {0b110111, 0b000111, 0b110100, 0b000100};
+
+/**
+ * Encode one byte of pixel data for UART output
+ * @param value pixel byte
+ * @param out 4 UART bytes, first bit pair first
+ **/
+void IRAM_ATTR ws2812_uart_encode(uint8_t value, uint8_t* out){
+    out[0] = uart_encoding[(value >> 6) & 0x03];
+    out[1] = uart_encoding[(value >> 4) & 0x03];
+    out[2] = uart_encoding[(value >> 2) & 0x03];
+    out[3] = uart_encoding[value & 0x03];
+}
+
+/**
+ * Write several strips. The blocking outputs go first: with interrupts off, a background
+ * transfer already started couldn't refill its FIFO, and the line would sit low long enough
+ * for the strip to latch part of a frame.
+ * @param outputs to show
+ * @param count number of outputs
+ **/
+void led_output_show(LED_Output* const* outputs, uint8_t count){
+    for(uint8_t i = 0; i < count; i++){
+        if(outputs[i]->blocking()) outputs[i]->show();
+    }
+    for(uint8_t i = 0; i < count; i++){
+        if(!outputs[i]->blocking()) outputs[i]->show();
+    }
+}
+
+/**
+ * Constructor
+ * @param strip to output
+ **/
+LED_Output_Bitbang::LED_Output_Bitbang(Adafruit_NeoPixel& strip) : _strip(strip){}
+
+/**
+ * Initialize output
+ **/
+void LED_Output_Bitbang::begin(){
+    _strip.begin();
+}
+
+/**
+ * Write the strip buffer to the LEDs (blocks until done)
+ **/
+void LED_Output_Bitbang::show(){
+    _strip.show();
+}
+
+/**
+ * @return true if a frame can't be written yet
+ **/
+bool LED_Output_Bitbang::busy(){
+    return !_strip.canShow();
+}
+
+/**
+ * @return true, interrupts are disabled while writing
+ **/
+bool LED_Output_Bitbang::blocking(){
+    return true;
+}
+
+/**
+ * Constructor
+ * @param strip to output (must be on GPIO2)
+ **/
+LED_Output_UART::LED_Output_UART(Adafruit_NeoPixel& strip) : _strip(strip){}
+
+/**
+ * Initialize UART1 for WS2812 output
+ **/
+void LED_Output_UART::begin(){
+    _strip.begin();
+    _length = _strip.numPixels() * 3;
+    _buffer = (uint8_t*)malloc(_length);
+
+    // 6N1 at 4x the LED bit rate, inverted so the idle line is low
+    Serial1.begin(WS2812_UART_BAUD, SERIAL_6N1, SERIAL_TX_ONLY);
+    USC0(UART1) |= (1 << UCTXI);
+    USC1(UART1) = (UART_FIFO_THRESHOLD << UCFET);
+    USIE(UART1) = 0;
+    USIC(UART1) = 0xFFFF;
+
+    ETS_UART_INTR_ATTACH(isr, this);
+    ETS_UART_INTR_ENABLE();
+}
+
+/**
+ * Copy the strip buffer and start sending it (returns immediately)
+ **/
+void LED_Output_UART::show(){
+    if(_buffer == NULL || busy()) return;
+
+    memcpy(_buffer, _strip.getPixels(), _length);
+    _position = 0;
+    _sending = true;
+
+    // Fill the FIFO now, the interrupt takes over when it runs low
+    fill_fifo();
+    if(_sending) USIE(UART1) |= (1 << UIFE);
+}
+
+/**
+ * @return true while a frame is being sent or the strip is latching
+ **/
+bool LED_Output_UART::busy(){
+    if(_sending) return true;
+    return micros() - _done_time < WS2812_UART_DRAIN_TIME + WS2812_LATCH_TIME;
+}
+
+/**
+ * @return false, the CPU is free while the frame is sent
+ **/
+bool LED_Output_UART::blocking(){
+    return false;
+}
+
+/**
+ * Move as many encoded bytes into the TX FIFO as fit
+ **/
+void IRAM_ATTR LED_Output_UART::fill_fifo(){
+    uint8_t encoded[4];
+    while(_position < _length){
+        uint8_t fifo_count = (USS(UART1) >> USTXC) & 0xFF;
+        if(fifo_count > UART_FIFO_SIZE - 4) return;
+
+        ws2812_uart_encode(_buffer[_position++], encoded);
+        USF(UART1) = encoded[0];
+        USF(UART1) = encoded[1];
+        USF(UART1) = encoded[2];
+        USF(UART1) = encoded[3];
+    }
+
+    // Everything is queued, stop the interrupt
+    USIE(UART1) &= ~(1 << UIFE);
+    _done_time = micros();
+    _sending = false;
+}
+
+/**
+ * UART interrupt: refill the TX FIFO when it runs low
+ **/
+void IRAM_ATTR LED_Output_UART::isr(void* arg){
+    LED_Output_UART* output = (LED_Output_UART*)arg;
+    if(USIS(UART1) & (1 << UIFE)){
+        output->fill_fifo();
+    }
+    USIC(UART1) = 0xFFFF;
+}
@@ -0,0 +1,73 @@
+/**
+ * LED Output Library
+ * Output backends for WS2812 LED strips. Each backend clocks out the pixel buffer of an
+ * Adafruit_NeoPixel strip.
+ *  -LED_Output_Bitbang: Adafruit NeoPixel show(). Blocks with interrupts disabled.
+ *  -LED_Output_UART: UART1 TX (GPIO2 only). Copies the frame and returns immediately, the
+ *   TX FIFO is refilled from the UART interrupt.
+ * 
+ * The UART backend takes over the UART interrupt, so Serial must be used TX only
+ * (SERIAL_TX_ONLY) while it is active. It also needs that interrupt to run every ~240us until
+ * the frame is queued, so show several outputs with led_output_show(), which sends the
+ * blocking ones first.
+ **/
+#include "Arduino.h"
+#include "Adafruit_NeoPixel.h"
+
+// UART baud rate for WS2812 (4 UART bits per LED bit at 800KHz)
+#define WS2812_UART_BAUD        3200000
+// Time to drain a full TX FIFO at WS2812_UART_BAUD (us)
+#define WS2812_UART_DRAIN_TIME  320
+// Low time required for the strip to latch a frame (us)
+#define WS2812_LATCH_TIME       300
+// Refill the TX FIFO when it drops below this many bytes
+#define UART_FIFO_THRESHOLD     32
+#define UART_FIFO_SIZE          128
+
+void ws2812_uart_encode(uint8_t value, uint8_t* out);
+
+class LED_Output;
+void led_output_show(LED_Output* const* outputs, uint8_t count);
+
+class LED_Output{
+    public:
+        virtual void begin() = 0;
+        virtual void show() = 0;
+        virtual bool busy() = 0;
+        virtual bool blocking() = 0;
+};
+
+class LED_Output_Bitbang : public LED_Output{
+    public:
+        LED_Output_Bitbang(Adafruit_NeoPixel& strip);
+
+        void begin();
+        void show();
+        bool busy();
+        bool blocking();
+
+    private:
+        Adafruit_NeoPixel& _strip;
+};
+
+class LED_Output_UART : public LED_Output{
+    public:
+        LED_Output_UART(Adafruit_NeoPixel& strip);
+
+        void begin();
+        void show();
+        bool busy();
+        bool blocking();
+
+    private:
+        Adafruit_NeoPixel& _strip;
+
+        uint8_t* _buffer = NULL;
+        uint16_t _length = 0;
+        volatile uint16_t _position = 0;
+        volatile bool _sending = false;
+        volatile uint32_t _done_time = 0;
+
+        static void isr(void* arg);
+        void fill_fifo();
+};
@@ -0,0 +1,278 @@
+/**
+ * Matrix Canvas Library
+ * Fixed-size RGB565 canvas for WS2812 matrix displays, with a compile-time lookup table
+ * from (x,y) to strip index. Drawing primitives write straight into the canvas without
+ * virtual calls, and write_strip() converts the whole canvas into a NeoPixel buffer.
+ * 
+ * Pixel_Map reproduces the Adafruit_NeoMatrix pixel order for the same matrix type byte.
+ * Requires C++14 or newer.
+ **/
+#include "Arduino.h"
+
+// Matrix layout flags (same values as Adafruit_NeoMatrix)
+#ifndef NEO_MATRIX_TOP
+#define NEO_MATRIX_TOP          0x00
+#define NEO_MATRIX_BOTTOM       0x01
+#define NEO_MATRIX_LEFT         0x00
+#define NEO_MATRIX_RIGHT        0x02
+#define NEO_MATRIX_CORNER       0x03
+#define NEO_MATRIX_ROWS         0x00
+#define NEO_MATRIX_COLUMNS      0x04
+#define NEO_MATRIX_AXIS         0x04
+#define NEO_MATRIX_PROGRESSIVE  0x00
+#define NEO_MATRIX_ZIGZAG       0x08
+#define NEO_MATRIX_SEQUENCE     0x08
+
+#define NEO_TILE_TOP            0x00
+#define NEO_TILE_BOTTOM         0x10
+#define NEO_TILE_LEFT           0x00
+#define NEO_TILE_RIGHT          0x20
+#define NEO_TILE_CORNER         0x30
+#define NEO_TILE_ROWS           0x00
+#define NEO_TILE_COLUMNS        0x40
+#define NEO_TILE_AXIS           0x40
+#define NEO_TILE_PROGRESSIVE    0x00
+#define NEO_TILE_ZIGZAG         0x80
+#define NEO_TILE_SEQUENCE       0x80
+#endif
+
+// Gamma correction for 5 and 6 bit color channels (gamma 2.5)
+static const uint8_t gamma5[32] = {
+      0,   0,   0,   1,   2,   3,   4,   6,   9,  12,  15,  19,  24,  29,  35,  42,
+     49,  57,  66,  75,  85,  96, 108, 121, 134, 149, 164, 181, 198, 216, 235, 255};
+static const uint8_t gamma6[64] = {
+      0,   0,   0,   0,   0,   0,   1,   1,   1,   2,   3,   3,   4,   5,   6,   7,
+      8,  10,  11,  13,  14,  16,  18,  21,  23,  25,  28,  31,  34,  37,  40,  43,
+     47,  51,  55,  59,  63,  67,  72,  77,  82,  87,  93,  98, 104, 110, 116, 123,
+    129, 136, 143, 150, 158, 166, 173, 182, 190, 199, 207, 216, 226, 235, 245, 255};
+
+/**
+ * Lookup table from canvas pixel (y * WIDTH + x) to strip index
+ * @param WIDTH of display
+ * @param HEIGHT of display
+ * @param TILE_WIDTH of each matrix tile
+ * @param TILE_HEIGHT of each matrix tile
+ * @param TYPE matrix and tile layout flags
+ **/
+template<uint8_t WIDTH, uint8_t HEIGHT, uint8_t TILE_WIDTH, uint8_t TILE_HEIGHT, uint8_t TYPE>
+struct Pixel_Map{
+    uint16_t index[WIDTH * HEIGHT];
+
+    constexpr Pixel_Map() : index(){
+        for(uint16_t y = 0; y < HEIGHT; y++){
+            for(uint16_t x = 0; x < WIDTH; x++){
+                index[y * WIDTH + x] = remap(x, y);
+            }
+        }
+    }
+
+    /**
+     * Strip index of a pixel (same arithmetic as Adafruit_NeoMatrix::drawPixel)
+     * @param x of pixel
+     * @param y of pixel
+     * @return index in strip
+     **/
+    static constexpr uint16_t remap(uint16_t x, uint16_t y){
+        const uint16_t tiles_x = WIDTH / TILE_WIDTH;
+        const uint16_t tiles_y = HEIGHT / TILE_HEIGHT;
+        uint8_t corner = TYPE & NEO_MATRIX_CORNER;
+        uint16_t minor = x / TILE_WIDTH;
+        uint16_t major = y / TILE_HEIGHT;
+        uint16_t major_scale = 0;
+        uint16_t tile = 0;
+        uint16_t swap = 0;
+
+        // Tile number
+        x = x - minor * TILE_WIDTH;
+        y = y - major * TILE_HEIGHT;
+        if(TYPE & NEO_TILE_RIGHT) minor = tiles_x - 1 - minor;
+        if(TYPE & NEO_TILE_BOTTOM) major = tiles_y - 1 - major;
+        if((TYPE & NEO_TILE_AXIS) == NEO_TILE_ROWS){
+            major_scale = tiles_x;
+        }else{
+            swap = major; major = minor; minor = swap;
+            major_scale = tiles_y;
+        }
+        if((TYPE & NEO_TILE_SEQUENCE) == NEO_TILE_PROGRESSIVE){
+            tile = major * major_scale + minor;
+        }else if(major & 1){
+            corner ^= NEO_MATRIX_CORNER;
+            tile = (major + 1) * major_scale - 1 - minor;
+        }else{
+            tile = major * major_scale + minor;
+        }
+
+        // Pixel number within tile
+        minor = x;
+        major = y;
+        if(corner & NEO_MATRIX_RIGHT) minor = TILE_WIDTH - 1 - minor;
+        if(corner & NEO_MATRIX_BOTTOM) major = TILE_HEIGHT - 1 - major;
+        if((TYPE & NEO_MATRIX_AXIS) == NEO_MATRIX_ROWS){
+            major_scale = TILE_WIDTH;
+        }else{
+            swap = major; major = minor; minor = swap;
+            major_scale = TILE_HEIGHT;
+        }
+
+        uint16_t pixel = 0;
+        if((TYPE & NEO_MATRIX_SEQUENCE) == NEO_MATRIX_PROGRESSIVE || !(major & 1)){
+            pixel = major * major_scale + minor;
+        }else{
+            pixel = (major + 1) * major_scale - 1 - minor;
+        }
+
+        return tile * TILE_WIDTH * TILE_HEIGHT + pixel;
+    }
+};
+
+/**
+ * RGB565 canvas
+ * @param WIDTH of canvas
+ * @param HEIGHT of canvas
+ **/
+template<uint8_t WIDTH, uint8_t HEIGHT>
+class Matrix_Canvas{
+    public:
+        uint16_t pixels[WIDTH * HEIGHT];
+
+        /**
+         * Fill the canvas with one color
+         * @param color RGB565
+         **/
+        void fill(uint16_t color){
+            for(uint16_t i = 0; i < WIDTH * HEIGHT; i++) pixels[i] = color;
+        }
+
+        /**
+         * Draw a pixel (clipped)
+         **/
+        inline void draw_pixel(int16_t x, int16_t y, uint16_t color){
+            if((uint16_t)x < WIDTH && (uint16_t)y < HEIGHT) pixels[y * WIDTH + x] = color;
+        }
+
+        /**
+         * Get a pixel (black if outside the canvas)
+         **/
+        inline uint16_t get_pixel(int16_t x, int16_t y) const{
+            if((uint16_t)x < WIDTH && (uint16_t)y < HEIGHT) return pixels[y * WIDTH + x];
+            return 0;
+        }
+
+        /**
+         * Draw a horizontal line
+         **/
+        void draw_hline(int16_t x, int16_t y, int16_t w, uint16_t color){
+            if((uint16_t)y >= HEIGHT) return;
+            if(x < 0){ w += x; x = 0; }
+            if(x + w > WIDTH) w = WIDTH - x;
+            uint16_t* p = &pixels[y * WIDTH + x];
+            for(int16_t i = 0; i < w; i++) p[i] = color;
+        }
+
+        /**
+         * Draw a vertical line
+         **/
+        void draw_vline(int16_t x, int16_t y, int16_t h, uint16_t color){
+            if((uint16_t)x >= WIDTH) return;
+            if(y < 0){ h += y; y = 0; }
+            if(y + h > HEIGHT) h = HEIGHT - y;
+            for(int16_t i = 0; i < h; i++) pixels[(y + i) * WIDTH + x] = color;
+        }
+
+        /**
+         * Draw a line between two points (Bresenham)
+         **/
+        void draw_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color){
+            if(y0 == y1){
+                if(x1 < x0){ int16_t t = x0; x0 = x1; x1 = t; }
+                draw_hline(x0, y0, x1 - x0 + 1, color);
+                return;
+            }
+            if(x0 == x1){
+                if(y1 < y0){ int16_t t = y0; y0 = y1; y1 = t; }
+                draw_vline(x0, y0, y1 - y0 + 1, color);
+                return;
+            }
+            int16_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+            int16_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+            int16_t error = dx + dy;
+            while(true){
+                draw_pixel(x0, y0, color);
+                if(x0 == x1 && y0 == y1) break;
+                int16_t e2 = 2 * error;
+                if(e2 >= dy){ error += dy; x0 += sx; }
+                if(e2 <= dx){ error += dx; y0 += sy; }
+            }
+        }
+
+        /**
+         * Draw a filled rectangle
+         **/
+        void fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+            for(int16_t i = 0; i < h; i++) draw_hline(x, y + i, w, color);
+        }
+
+        /**
+         * Draw a rectangle outline
+         **/
+        void draw_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+            draw_hline(x, y, w, color);
+            draw_hline(x, y + h - 1, w, color);
+            draw_vline(x, y, h, color);
+            draw_vline(x + w - 1, y, h, color);
+        }
+
+        /**
+         * Draw a 1-bit bitmap (Adafruit GFX format: rows MSB first, padded to a byte)
+         * @param bitmap in PROGMEM
+         **/
+        void draw_bitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, 
+                uint16_t color){
+            int16_t byte_width = (w + 7) / 8;
+            for(int16_t j = 0; j < h; j++){
+                uint8_t bits = 0;
+                for(int16_t i = 0; i < w; i++){
+                    if(i & 7) bits <<= 1;
+                    else bits = pgm_read_byte(&bitmap[j * byte_width + i / 8]);
+                    if(bits & 0x80) draw_pixel(x + i, y + j, color);
+                }
+            }
+        }
+
+        /**
+         * Draw a packed column bitmap (bit y of each column is row y)
+         * @param x of first column
+         * @param columns bitmap
+         * @param width number of columns
+         **/
+        void draw_columns(int16_t x, const uint16_t* columns, uint16_t width, uint16_t color){
+            int16_t start = x < 0 ? -x : 0;
+            int16_t end = WIDTH - x;
+            if(end > (int16_t)width) end = width;
+            for(int16_t column = start; column < end; column++){
+                uint16_t bits = columns[column];
+                uint16_t* p = &pixels[x + column];
+                for(uint8_t y = 0; bits && y < HEIGHT; y++, bits >>= 1){
+                    if(bits & 1) p[y * WIDTH] = color;
+                }
+            }
+        }
+
+        /**
+         * Convert the canvas into a NeoPixel GRB buffer (gamma corrected and scaled)
+         * @param map from canvas pixel to strip index
+         * @param strip buffer (3 bytes per pixel)
+         * @param brightness scale [0,255]
+         **/
+        template<class MAP>
+        void write_strip(const MAP& map, uint8_t* strip, uint8_t brightness) const{
+            uint16_t scale = brightness + 1;
+            for(uint16_t i = 0; i < WIDTH * HEIGHT; i++){
+                uint16_t color = pixels[i];
+                uint8_t* p = &strip[map.index[i] * 3];
+                p[0] = (gamma6[(color >> 5) & 0x3F] * scale) >> 8;
+                p[1] = (gamma5[color >> 11] * scale) >> 8;
+                p[2] = (gamma5[color & 0x1F] * scale) >> 8;
+            }
+        }
+};
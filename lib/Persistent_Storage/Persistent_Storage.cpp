@@ -6,6 +6,22 @@
     store or change a key:value pair, and get() to retrieve a value based on the
     key. Use remove() to delete a key:value pair. 
 
+    Changes are kept in RAM and written to the file once there have been none for
+    PERSISTENT_STORAGE_QUIET_TIME, so call handle() every loop or as often as 
+    possible. Call flush() (or flush_all() for every object) to write them straight 
+    away, e.g. before a restart. The file is replaced by writing a temporary file 
+    and renaming it, so a write that is cut off never leaves a half-written file.
+
+    Build with -D PERSISTENT_STORAGE_LOG to store pairs in an append-only log
+    (/<name>.log) instead of a JSON file. Each write only appends the pairs that
+    changed, as records of:
+        key length (1 byte), value length (2 bytes, 0xFFFF if removed), key, value, 
+        CRC-16 of all of the above (2 bytes)
+    The log is replayed into RAM on first use, stopping at the first record that is
+    cut off or fails its CRC, and is rewritten with only the live pairs (compacted)
+    when it grows past PERSISTENT_STORAGE_LOG_LIMIT or its tail is damaged. An 
+    existing JSON file is moved into the log on first use.
+
     Created by Silviu Toderita in 2020.
     silviu.toderita@gmail.com
     silviutoderita.com
@@ -13,73 +29,161 @@
 
 #include "Persistent_Storage.h"
 
+Persistent_Storage* Persistent_Storage::first = NULL;
+
+uint32_t Persistent_Storage::writes = 0;
+uint32_t Persistent_Storage::bytes_written = 0;
+uint32_t Persistent_Storage::sets = 0;
+uint32_t Persistent_Storage::bytes_set = 0;
+uint32_t Persistent_Storage::commit_time = 0;
+uint32_t Persistent_Storage::max_commit_time = 0;
+uint32_t Persistent_Storage::recoveries = 0;
+
 /*  Persistent_Storage Constructor
         name: The name of this storage object
 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
 Persistent_Storage::Persistent_Storage(String name){
+#ifdef PERSISTENT_STORAGE_LOG
+    path = "/" + name + ".log";
+    json_path = "/" + name + ".txt";
+#else
     path = "/" + name + ".txt";
-    SPIFFS.begin();
+#endif
+    temp_path = path + ".tmp";
+
+    next = first;
+    first = this;
 }
 
-/*  put: Add a new key:value pair to storage, or modify the value of an existing key
-        key:
-        value:
-    RETURNS True if successful, false if not
+/*  (private)load: Read the file into RAM, the first time it's needed
 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
-bool Persistent_Storage::set(String key, String value){ 
-    //If the key is blank, it can't be stored
-    if(key == "") return false;
+void Persistent_Storage::load(){
+    if(loaded) return;
+    loaded = true;
+    storage_begin();
+
+    //The old file is only removed once the new one is complete, so if it's missing the 
+    //temporary file is good. Otherwise the temporary file is from a write that was cut off.
+    if(storage.exists(temp_path)){
+        bool complete = !storage.exists(path);
+#ifdef PERSISTENT_STORAGE_LOG
+        //The same goes for the JSON file when its pairs are moved into the first log, so while
+        //it's still there the move is made again
+        complete = complete && !storage.exists(json_path);
+#endif
+        if(complete){
+            storage.rename(temp_path, path);
+            recoveries++;
+        }else{
+            storage.remove(temp_path);
+        }
+    }
 
+#ifdef PERSISTENT_STORAGE_LOG
+    load_log();
+#else
+    load_json(path);
+#endif
+}
+
+/*  (private)load_json: Read key:value pairs from a JSON file into RAM
+        json: Path of the file
+    RETURNS True if the file was read, false if it's missing or damaged
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+bool Persistent_Storage::load_json(const String& json){
     //Open the file for reading
-    File file = SPIFFS.open(path, "r");
+    File file = storage.open(json, "r");
+    if(!file) return false;
     //Set aside enough memory for a JSON document
     DynamicJsonDocument doc(file.size() * 2 + 256);
 
     //Parse JSON from file
-    deserializeJson(doc, file);
-    
-    //Close the file for reading
+    DeserializationError error = deserializeJson(doc, file);
+
+    //Close the file
     file.close();
-    
-    //Add/change the value in the file
-    doc[key] = value;
 
-    //Open the file for writing
-    file = SPIFFS.open(path, "w");
+    //If there are any issues, start empty
+    if(error) return false;
 
-    bool status = false;
-    //Export the JSON to the file
-    if(serializeJson(doc, file)){
-        status = true;
-    } 
+    //Copy each key:value pair
+    for(JsonPair pair : doc.as<JsonObject>()){
+        if(size == PERSISTENT_STORAGE_MAX_KEYS) break;
+        keys[size] = pair.key().c_str();
+        values[size] = pair.value().as<String>();
+        size++;
+    }
+    return true;
+}
 
-    file.close();
-    return status;
+/*  (private)find: Find a key
+        key:
+    RETURNS Index of the key, or -1 if it's not stored
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+int16_t Persistent_Storage::find(const String& key){
+    for(uint8_t i = 0; i < size; i++){
+        if(keys[i] == key) return i;
+    }
+    return -1;
 }
 
-/*  get_value: Get the value of a specific key 
+/*  (private)mark_changed: Note a change to write to the file later
+        key: Key that changed
+        value: New value
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+void Persistent_Storage::mark_changed(const String& key, const String& value){
+    changed = true;
+    changed_at = millis();
+    sets++;
+    bytes_set += key.length() + value.length();
+}
+
+/*  put: Add a new key:value pair to storage, or modify the value of an existing key
         key:
-    RETURNS Value of the key. If the key is not found, returns "".
+        value:
+    RETURNS True if successful, false if not
 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
-String Persistent_Storage::get(String key){
-    //Open the file for reading
-    File file = SPIFFS.open(path, "r");
-    //Set aside enough memory for a JSON document
-    DynamicJsonDocument doc(file.size() * 2);
+bool Persistent_Storage::set(String key, String value){ 
+    //If the key is blank, it can't be stored
+    if(key == "") return false;
+#ifdef PERSISTENT_STORAGE_LOG
+    //If the pair doesn't fit in a record, it can't be stored
+    if(key.length() > 255 || key.length() + value.length() > PERSISTENT_STORAGE_MAX_RECORD){
+        return false;
+    }
+#endif
+    load();
 
-    //Parse JSON from file
-    DeserializationError error = deserializeJson(doc, file);
+    int16_t index = find(key);
+    if(index < 0){
+        //If there's no room, it can't be stored
+        if(size == PERSISTENT_STORAGE_MAX_KEYS) return false;
+        index = size++;
+        keys[index] = key;
+    }else if(values[index] == value){
+        //Nothing to write
+        return true;
+    }
 
-    //Close the file
-    file.close();
+    values[index] = value;
+#ifdef PERSISTENT_STORAGE_LOG
+    key_changed[index] = true;
+#endif
+    mark_changed(key, value);
+    return true;
+}
 
-    //If there are any issues, return a blank string
-    if(error){
-        return "";
-    } 
+/*  get_value: Get the value of a specific key 
+        key:
+    RETURNS Value of the key. If the key is not found, returns "".
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+String Persistent_Storage::get(String key){
+    load();
 
     //Return the value corresponding to the key. If the key doesn't exist, return a blank string
-    return doc[key] | "";
+    int16_t index = find(key);
+    if(index < 0) return "";
+    return values[index];
 }
 
 /*  remove: Delete a key:value pair
@@ -89,30 +193,370 @@ String Persistent_Storage::get(String key){
 bool Persistent_Storage::remove(String key){ 
     //If the key is blank, there is nothing to remove
     if(key == "") return false;
+    load();
 
-    //Open the file for reading
-    File file = SPIFFS.open(path, "r");
+    int16_t index = find(key);
+    if(index < 0) return true;
+
+#ifdef PERSISTENT_STORAGE_LOG
+    //Log the removal, unless it already will be
+    bool logged = false;
+    for(uint8_t i = 0; i < num_removed; i++){
+        if(removed[i] == key) logged = true;
+    }
+    if(!logged){
+        //If there's no room to remember another removal, write the ones waiting now
+        if(num_removed == PERSISTENT_STORAGE_MAX_KEYS && !flush()) return false;
+        removed[num_removed++] = key;
+    }
+    erase(index);
+#else
+    //Move the following pairs down
+    size--;
+    for(uint8_t i = index; i < size; i++){
+        keys[i] = keys[i + 1];
+        values[i] = values[i + 1];
+    }
+    keys[size] = "";
+    values[size] = "";
+#endif
+
+    mark_changed(key, "");
+    return true;
+}
+
+/*  handle: Write changes to the file once they have stopped (run every loop)
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+void Persistent_Storage::handle(){
+    if(changed && millis() - changed_at >= PERSISTENT_STORAGE_QUIET_TIME) flush();
+}
+
+/*  time_to_next: 
+    RETURNS Time until changes are due to be written (ms), or UINT32_MAX if there are none
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+uint32_t Persistent_Storage::time_to_next(){
+    if(!changed) return UINT32_MAX;
+    int32_t left = changed_at + PERSISTENT_STORAGE_QUIET_TIME - millis();
+    return left > 0 ? left : 0;
+}
+
+/*  flush: Write changes to the file now
+    RETURNS True if the file is up to date, false if the write failed
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+bool Persistent_Storage::flush(){
+    if(!changed) return true;
+    uint32_t start = micros();
+
+    bool status = commit();
+
+    //Try again after another quiet period if it failed
+    changed = !status;
+    changed_at = millis();
+
+    commit_time = micros() - start;
+    if(commit_time > max_commit_time) max_commit_time = commit_time;
+    return status;
+}
+
+#ifndef PERSISTENT_STORAGE_LOG
+/*  (private)commit: Replace the JSON file with the pairs in RAM
+    RETURNS True if successful, false if not
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+bool Persistent_Storage::commit(){
     //Set aside enough memory for a JSON document
-    DynamicJsonDocument doc(file.size() * 2);
+    size_t capacity = JSON_OBJECT_SIZE(size) + 64;
+    for(uint8_t i = 0; i < size; i++) capacity += keys[i].length() + values[i].length() + 2;
+    DynamicJsonDocument doc(capacity);
+    JsonObject object = doc.to<JsonObject>();
+    for(uint8_t i = 0; i < size; i++) object[keys[i]] = values[i];
 
-    //Parse JSON from file
-    deserializeJson(doc, file);
-    
-    //Close the file for reading
-    file.close();
-    
-    //Add/change the value in the file
-    doc.remove(key);
+    //Write the temporary file, then check all of it made it
+    File file = storage.open(temp_path, "w");
+    size_t length = 0;
+    if(file){
+        length = serializeJson(doc, file);
+        file.close();
+        writes++;
+        bytes_written += length;
+        file = storage.open(temp_path, "r");
+    }
+    bool status = file && length && file.size() == length;
+    if(file) file.close();
+
+    //Replace the file with the temporary file
+    if(status){
+        storage.remove(path);
+        status = storage.rename(temp_path, path);
+    }else{
+        storage.remove(temp_path);
+    }
+    return status;
+}
+#endif
 
-    //Open the file for writing
-    file = SPIFFS.open(path, "w");
+#ifdef PERSISTENT_STORAGE_LOG
+#define LOG_REMOVED 0xFFFF //Value length of a record that removes its key
 
-    bool status = false;
-    //Export the JSON to the file
-    if(serializeJson(doc, file)){
-        status = true;
-    } 
+/*  (private)log_crc: Update a CRC-16 (CCITT) with some bytes
+        crc: CRC so far, 0xFFFF to start
+        data: Bytes to add
+        length: Number of bytes
+    RETURNS The new CRC
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+uint16_t log_crc(uint16_t crc, const uint8_t* data, size_t length){
+    for(size_t i = 0; i < length; i++){
+        crc ^= data[i] << 8;
+        for(uint8_t bit = 0; bit < 8; bit++){
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/*  (private)load_log: Replay the log into RAM. If there's no log yet, move the pairs 
+    from the JSON file into one.
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+void Persistent_Storage::load_log(){
+    File file = storage.open(path, "r");
+    if(!file){
+        if(load_json(json_path) && compact()) storage.remove(json_path);
+        return;
+    }
 
+    uint8_t record[3 + PERSISTENT_STORAGE_MAX_RECORD + 2];
+    uint32_t file_size = file.size();
+    log_size = 0;
+    while(true){
+        //Stop at the first record that is cut off or damaged
+        if(file.read(record, 3) != 3) break;
+        uint8_t key_length = record[0];
+        uint16_t value_length = record[1] | record[2] << 8;
+        size_t data_length = key_length + (value_length == LOG_REMOVED ? 0 : value_length);
+        if(key_length == 0 || data_length > PERSISTENT_STORAGE_MAX_RECORD) break;
+        if(file.read(record + 3, data_length + 2) != data_length + 2) break;
+        uint16_t crc = record[3 + data_length] | record[4 + data_length] << 8;
+        if(log_crc(0xFFFF, record, 3 + data_length) != crc) break;
+
+        String key;
+        key.concat((const char*)record + 3, key_length);
+        if(value_length == LOG_REMOVED){
+            int16_t index = find(key);
+            if(index >= 0) erase(index);
+        }else{
+            String value;
+            value.concat((const char*)record + 3 + key_length, value_length);
+            store(key, value);
+        }
+        log_size += 5 + data_length;
+    }
     file.close();
+
+    //Anything appended after a damaged record would be lost too, so rewrite the log without it
+    if(log_size != file_size){
+        recoveries++;
+        compact();
+    }
+}
+
+/*  (private)store: Set a pair in RAM without logging it (it's already in the log)
+        key:
+        value:
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+void Persistent_Storage::store(const String& key, const String& value){
+    int16_t index = find(key);
+    if(index < 0){
+        if(size == PERSISTENT_STORAGE_MAX_KEYS) return;
+        index = size++;
+        keys[index] = key;
+    }
+    values[index] = value;
+    key_changed[index] = false;
+}
+
+/*  (private)erase: Remove a pair from RAM, moving the following pairs down
+        index: Index of the pair
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+void Persistent_Storage::erase(int16_t index){
+    size--;
+    for(uint8_t i = index; i < size; i++){
+        keys[i] = keys[i + 1];
+        values[i] = values[i + 1];
+        key_changed[i] = key_changed[i + 1];
+    }
+    keys[size] = "";
+    values[size] = "";
+    key_changed[size] = false;
+}
+
+/*  (private)write_record: Write one record to the log
+        file: Log open for writing
+        key:
+        value: New value, or NULL if the key was removed
+    RETURNS Size of the record, or 0 if it couldn't all be written
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+size_t Persistent_Storage::write_record(File& file, const String& key, const String* value){
+    uint16_t value_length = value != NULL ? value->length() : LOG_REMOVED;
+    uint8_t header[3] = {(uint8_t)key.length(), (uint8_t)value_length, (uint8_t)(value_length >> 8)};
+
+    uint16_t crc = log_crc(0xFFFF, header, 3);
+    crc = log_crc(crc, (const uint8_t*)key.c_str(), key.length());
+    if(value != NULL) crc = log_crc(crc, (const uint8_t*)value->c_str(), value->length());
+    uint8_t footer[2] = {(uint8_t)crc, (uint8_t)(crc >> 8)};
+
+    size_t expected = 5 + key.length() + (value != NULL ? value->length() : 0);
+    size_t length = file.write(header, 3);
+    length += file.write((const uint8_t*)key.c_str(), key.length());
+    if(value != NULL) length += file.write((const uint8_t*)value->c_str(), value->length());
+    length += file.write(footer, 2);
+    return length == expected ? length : 0;
+}
+
+/*  (private)commit: Append the pairs that changed to the log, compacting it if needed
+    RETURNS True if successful, false if not
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+bool Persistent_Storage::commit(){
+    File file = storage.open(path, "a");
+    bool status = file ? true : false;
+    uint32_t appended = 0;
+
+    //One record per key, so a write that is cut off leaves each key old or new. A key that 
+    //was removed and then set again only needs the set.
+    for(uint8_t i = 0; status && i < num_removed; i++){
+        if(find(removed[i]) >= 0) continue;
+        size_t length = write_record(file, removed[i], NULL);
+        appended += length;
+        status = length > 0;
+    }
+    for(uint8_t i = 0; status && i < size; i++){
+        if(!key_changed[i]) continue;
+        size_t length = write_record(file, keys[i], &values[i]);
+        appended += length;
+        status = length > 0;
+    }
+    if(file){
+        file.close();
+        writes++;
+        bytes_written += appended;
+    }
+    log_size += appended;
+
+    if(status){
+        num_removed = 0;
+        for(uint8_t i = 0; i < size; i++) key_changed[i] = false;
+    }
+
+    //Rewrite the log if an append failed (a damaged record hides the ones after it), or if
+    //it's mostly old records
+    uint32_t live = 0;
+    for(uint8_t i = 0; i < size; i++) live += 5 + keys[i].length() + values[i].length();
+    if(!status || (log_size > PERSISTENT_STORAGE_LOG_LIMIT && log_size > live * 2)){
+        status = compact();
+    }
     return status;
-}
\ No newline at end of file
+}
+
+/*  (private)compact: Replace the log with one record for each pair in RAM
+    RETURNS True if successful, false if not
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+bool Persistent_Storage::compact(){
+    //Write the temporary file, then check all of it made it
+    File file = storage.open(temp_path, "w");
+    bool status = file ? true : false;
+    uint32_t length = 0;
+    for(uint8_t i = 0; status && i < size; i++){
+        size_t record = write_record(file, keys[i], &values[i]);
+        length += record;
+        status = record > 0;
+    }
+    if(file){
+        file.close();
+        writes++;
+        bytes_written += length;
+    }
+    if(status){
+        file = storage.open(temp_path, "r");
+        status = file && file.size() == length;
+        if(file) file.close();
+    }
+
+    //Replace the log with the temporary file
+    if(status){
+        storage.remove(path);
+        status = storage.rename(temp_path, path);
+    }else{
+        storage.remove(temp_path);
+    }
+
+    if(status){
+        log_size = length;
+        num_removed = 0;
+        for(uint8_t i = 0; i < size; i++) key_changed[i] = false;
+    }
+    return status;
+}
+#endif
+
+/*  dirty: 
+    RETURNS True if there are changes that haven't been written to the file yet
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+bool Persistent_Storage::dirty(){
+    return changed;
+}
+
+/*  flush_all: Write changes of all storage objects to their files now
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+void Persistent_Storage::flush_all(){
+    for(Persistent_Storage* storage = first; storage != NULL; storage = storage->next){
+        storage->flush();
+    }
+}
+
+/*  get_writes: 
+    RETURNS Number of file writes by all storage objects since boot
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+uint32_t Persistent_Storage::get_writes(){
+    return writes;
+}
+
+/*  get_bytes_written: 
+    RETURNS Number of bytes written by all storage objects since boot
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+uint32_t Persistent_Storage::get_bytes_written(){
+    return bytes_written;
+}
+
+/*  get_sets: 
+    RETURNS Number of changes (set or remove) made by all storage objects since boot
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+uint32_t Persistent_Storage::get_sets(){
+    return sets;
+}
+
+/*  get_bytes_set: 
+    RETURNS Number of key and value bytes changed by all storage objects since boot
+    (bytes written / bytes set is the write amplification)
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+uint32_t Persistent_Storage::get_bytes_set(){
+    return bytes_set;
+}
+
+/*  get_commit_time: 
+    RETURNS Time taken by the last file write (us)
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+uint32_t Persistent_Storage::get_commit_time(){
+    return commit_time;
+}
+
+/*  get_max_commit_time: 
+    RETURNS Longest time taken by a file write since boot (us)
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+uint32_t Persistent_Storage::get_max_commit_time(){
+    return max_commit_time;
+}
+
+/*  get_recoveries: 
+    RETURNS Number of files restored from the temporary file of an interrupted write
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+uint32_t Persistent_Storage::get_recoveries(){
+    return recoveries;
+}
@@ -1,7 +1,16 @@
 #include "Arduino.h"
-#include "FS.h" //SPI Flash File System (SPIFFS) Library
+#include "Storage.h" //File system the settings are kept in
 #include "ArduinoJson.h" //Arduino JavaScript Object Notation Library
 
+#define PERSISTENT_STORAGE_MAX_KEYS 16 //Most key:value pairs in one storage object
+#define PERSISTENT_STORAGE_QUIET_TIME 2000 //Time without changes before they are written (ms)
+
+//Build with -D PERSISTENT_STORAGE_LOG to append changed pairs to a log instead of rewriting a
+//JSON file. The log is compacted once it's bigger than this and twice the live pairs (bytes).
+#define PERSISTENT_STORAGE_LOG_LIMIT 4096
+//Largest key + value in a log record (bytes)
+#define PERSISTENT_STORAGE_MAX_RECORD 256
+
 class Persistent_Storage{
     
     public:
@@ -10,13 +19,76 @@ class Persistent_Storage{
     
         bool
             set(String key, String value),
-            remove(String key);
+            remove(String key),
+            flush(),
+            dirty();
 
         String 
             get(String key);
 
+        void
+            handle();
+
+        uint32_t
+            time_to_next();
+
+        static void
+            flush_all();
+
+        static uint32_t
+            get_writes(),
+            get_bytes_written(),
+            get_sets(),
+            get_bytes_set(),
+            get_commit_time(),
+            get_max_commit_time(),
+            get_recoveries();
+
     private:
 
         String path; //The path for this object
+        String temp_path; //The path new contents are written to before replacing the file
+
+        //Contents of the file, loaded on first use
+        String keys[PERSISTENT_STORAGE_MAX_KEYS];
+        String values[PERSISTENT_STORAGE_MAX_KEYS];
+        uint8_t size = 0;
+        bool loaded = false;
+
+        bool changed = false; //True if there are changes that aren't in the file yet
+        uint32_t changed_at = 0; //Time of the last change (ms)
+
+#ifdef PERSISTENT_STORAGE_LOG
+        String json_path; //JSON file from before the log, moved into it on first use
+        bool key_changed[PERSISTENT_STORAGE_MAX_KEYS]; //Pairs not in the log yet
+        String removed[PERSISTENT_STORAGE_MAX_KEYS]; //Keys removed but not in the log yet
+        uint8_t num_removed = 0;
+        uint32_t log_size = 0; //Bytes of valid records in the log
+#endif
+
+        Persistent_Storage* next; //Next storage object, so all can be flushed
+        static Persistent_Storage* first;
+
+        static uint32_t writes; //File writes by all storage objects since boot
+        static uint32_t bytes_written; //Bytes written by all storage objects since boot
+        static uint32_t sets; //Changes made by all storage objects since boot
+        static uint32_t bytes_set; //Key and value bytes of those changes
+        static uint32_t commit_time; //Time taken by the last file write (us)
+        static uint32_t max_commit_time; //Longest time taken by a file write (us)
+        static uint32_t recoveries; //Files restored from an interrupted write
+
+        void load();
+        int16_t find(const String& key);
+        void mark_changed(const String& key, const String& value);
+        bool commit();
+        bool load_json(const String& json);
+
+#ifdef PERSISTENT_STORAGE_LOG
+        void load_log();
+        void store(const String& key, const String& value);
+        void erase(int16_t index);
+        bool compact();
+        size_t write_record(File& file, const String& key, const String* value);
+#endif
 
-};
\ No newline at end of file
+};
@@ -0,0 +1,115 @@
+/**
+ * Profiler Library
+ * Times code stages with the CPU cycle counter. Each stage keeps min, mean, max and a
+ * log2 histogram (for the 99th percentile), reported over Serial.
+ **/
+#include "Profiler.h"
+
+#ifdef PROFILE
+
+Profiler profiler;
+
+/**
+ * Start profiling
+ * @param names of stages (printed in reports)
+ * @param num_stages number of stages [1,PROFILER_MAX_STAGES]
+ **/
+void Profiler::begin(const char* const* names, uint8_t num_stages){
+    _names = names;
+    _num_stages = min(num_stages, (uint8_t)PROFILER_MAX_STAGES);
+    reset();
+    last_report = millis();
+}
+
+/**
+ * Print a report every PROFILER_REPORT_TIME (run every loop)
+ * Lines are "profile,<stage>,<count>,<min_us>,<mean_us>,<p99_us>,<max_us>"
+ * @return true if a report was printed
+ **/
+bool Profiler::handle(){
+    if(millis() - last_report < PROFILER_REPORT_TIME) return false;
+    last_report = millis();
+
+    for(uint8_t i = 0; i < _num_stages; i++){
+        if(stages[i].count == 0) continue;
+        Serial.printf("profile,%s,%u,%u,%u,%u,%u\n", _names[i], stages[i].count,
+            to_us(stages[i].min), to_us(get_mean(i)), to_us(get_percentile(i, 99)), 
+            to_us(stages[i].max));
+    }
+    return true;
+}
+
+/**
+ * Record one run of a stage
+ * @param stage number
+ * @param cycles taken
+ **/
+void Profiler::record(uint8_t stage, uint32_t cycles){
+    if(stage >= _num_stages) return;
+    Profiler_Stage& s = stages[stage];
+
+    if(s.count == 0 || cycles < s.min) s.min = cycles;
+    if(cycles > s.max) s.max = cycles;
+    s.count++;
+    s.total += cycles;
+
+    uint8_t bucket = cycles ? 31 - __builtin_clz(cycles) : 0;
+    s.histogram[bucket]++;
+}
+
+/**
+ * Clear all statistics
+ **/
+void Profiler::reset(){
+    memset(stages, 0, sizeof(stages));
+}
+
+/**
+ * @param stage number
+ * @return mean time (cycles)
+ **/
+uint32_t Profiler::get_mean(uint8_t stage){
+    if(stages[stage].count == 0) return 0;
+    return stages[stage].total / stages[stage].count;
+}
+
+/**
+ * @param stage number
+ * @param percent percentile [0,100]
+ * @return upper bound of the histogram bucket holding the percentile, capped at the max (cycles)
+ **/
+uint32_t Profiler::get_percentile(uint8_t stage, uint8_t percent){
+    Profiler_Stage& s = stages[stage];
+    uint32_t target = ((uint64_t)s.count * percent + 99) / 100;
+    uint32_t seen = 0;
+    for(uint8_t i = 0; i < PROFILER_BUCKETS; i++){
+        seen += s.histogram[i];
+        if(seen >= target && seen > 0){
+            uint32_t bound = (i == 31) ? 0xFFFFFFFF : (2UL << i) - 1;
+            return min(bound, s.max);
+        }
+    }
+    return s.max;
+}
+
+/**
+ * Log scale level of a stage's mean time, for drawing (1us = level 1, doubling per level)
+ * @param stage number
+ * @param max_level highest level
+ * @return level [0,max_level]
+ **/
+uint8_t Profiler::get_level(uint8_t stage, uint8_t max_level){
+    uint32_t us = to_us(get_mean(stage));
+    if(us == 0) return 0;
+    uint8_t level = 32 - __builtin_clz(us);
+    return min(level, max_level);
+}
+
+/**
+ * Convert CPU cycles to microseconds
+ **/
+uint32_t Profiler::to_us(uint32_t cycles){
+    return cycles / ESP.getCpuFreqMHz();
+}
+
+#endif
@@ -0,0 +1,59 @@
+/**
+ * Profiler Library
+ * Times code stages with the CPU cycle counter. Each stage keeps min, mean, max and a
+ * log2 histogram (for the 99th percentile), reported over Serial.
+ * 
+ * Build with -D PROFILE to enable. Without it the PROFILE_START/PROFILE_END macros compile
+ * to nothing and no profiler is created.
+ * 
+ * Run the handle() function on each loop to print reports.
+ **/
+#include "Arduino.h"
+
+// Maximum number of stages
+#define PROFILER_MAX_STAGES     16
+// Histogram buckets (bucket n holds times of [2^n, 2^(n+1)) cycles)
+#define PROFILER_BUCKETS        32
+// Time between reports (ms)
+#define PROFILER_REPORT_TIME    5000
+
+#ifdef PROFILE
+#define PROFILE_START(stage)    uint32_t _profile_##stage = ESP.getCycleCount()
+#define PROFILE_END(stage)      profiler.record(stage, ESP.getCycleCount() - _profile_##stage)
+#else
+#define PROFILE_START(stage)
+#define PROFILE_END(stage)
+#endif
+
+struct Profiler_Stage{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t histogram[PROFILER_BUCKETS];
+};
+
+class Profiler{
+    public:
+        void begin(const char* const* names, uint8_t num_stages);
+        bool handle();
+
+        void record(uint8_t stage, uint32_t cycles);
+        void reset();
+
+        uint32_t get_mean(uint8_t stage);
+        uint32_t get_percentile(uint8_t stage, uint8_t percent);
+        uint8_t get_level(uint8_t stage, uint8_t max_level);
+
+    private:
+        const char* const* _names;
+        uint8_t _num_stages = 0;
+        Profiler_Stage stages[PROFILER_MAX_STAGES];
+        uint32_t last_report = 0;
+
+        uint32_t to_us(uint32_t cycles);
+};
+
+#ifdef PROFILE
+extern Profiler profiler;
+#endif
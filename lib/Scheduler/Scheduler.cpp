@@ -0,0 +1,390 @@
+/**
+ * Scheduler Library
+ * Runs many independent timers (call a function after some time) and triggers (call a 
+ * function when triggered).
+ * 
+ * Run the handle() function on each loop or as often as possible for correct timing.
+ **/
+#include "Scheduler.h"
+#ifndef SIMULATE
+#include "core_esp8266_waveform.h"
+#endif
+
+Scheduler scheduler;
+
+Scheduler::Scheduler(){
+    for(uint8_t i = 0; i < SCHEDULER_SLOTS; i++){
+        slots[i].active = false;
+        slots[i].generation = 0;
+    }
+}
+
+/**
+ * Start watching timers from the hardware timer interrupt. Without it (and in simulation, 
+ * where time is virtual) timers are only polled from handle().
+ **/
+void Scheduler::begin(){
+#ifndef SIMULATE
+    setTimer1Callback(isr);
+#endif
+}
+
+/**
+ * Set a timer
+ * @param callback void function to call
+ * @param time from now to call function (ms)
+ * @return handle of timer, or TIMER_NONE if all slots are in use
+ **/
+Timer_Handle Scheduler::set_timer(void_function_pointer callback, uint32_t time){
+    return set_timer_at(callback, clock_millis() + time);
+}
+
+/**
+ * Set a timer for an absolute time
+ * @param callback void function to call
+ * @param due time to call function (ms, as clock_millis())
+ * @return handle of timer, or TIMER_NONE if all slots are in use
+ **/
+Timer_Handle Scheduler::set_timer_at(void_function_pointer callback, uint32_t due){
+    Timer_Handle handle = allocate(callback);
+    if(handle == TIMER_NONE) return TIMER_NONE;
+
+    uint8_t slot = (handle & 0xFF) - 1;
+    slots[slot].due = due;
+    heap_push(slot);
+    arm();
+    return handle;
+}
+
+/**
+ * Set a trigger
+ * @param callback void function to call when triggered
+ * @return handle of trigger, or TIMER_NONE if all slots are in use
+ **/
+Timer_Handle Scheduler::set_trigger(void_function_pointer callback){
+    return allocate(callback);
+}
+
+/**
+ * Run a trigger (or a timer ahead of time) and remove it
+ * @param handle of trigger
+ * @return true if the callback was called
+ **/
+bool Scheduler::trigger(Timer_Handle handle){
+    Slot* slot = find(handle);
+    if(slot == NULL) return false;
+
+    void_function_pointer callback = slot->callback;
+    cancel(handle);
+    callback();
+    return true;
+}
+
+/**
+ * Remove a timer or trigger without calling it
+ * @param handle of timer or trigger
+ * @return true if it was still pending
+ **/
+bool Scheduler::cancel(Timer_Handle handle){
+    Slot* slot = find(handle);
+    if(slot == NULL) return false;
+
+    if(slot->heap_index < SCHEDULER_SLOTS){
+        heap_remove(slot->heap_index);
+        arm();
+    }
+    release(slot - slots);
+    return true;
+}
+
+/**
+ * @param handle of timer or trigger
+ * @return true if it hasn't run or been cancelled yet
+ **/
+bool Scheduler::pending(Timer_Handle handle){
+    return find(handle) != NULL;
+}
+
+/**
+ * Run all timers that are due (call every loop)
+ **/
+void Scheduler::handle(){
+    uint32_t now = clock_millis();
+
+    // Run timers the interrupt saw expire (if still set), and measure how late they are
+    while(ready_tail != ready_head){
+        Ready entry = ready[ready_tail];
+        ready_tail = (ready_tail + 1) % SCHEDULER_READY_SIZE;
+
+        Slot* slot = find(entry.handle);
+        if(slot == NULL || slot->heap_index >= SCHEDULER_SLOTS) continue;
+        if((int32_t)(now - slot->due) < 0) continue;
+
+        uint32_t jitter = entry.fired_ms - slot->due;
+        uint32_t latency = micros() - entry.fired_us;
+        if(jitter > max_jitter) max_jitter = jitter;
+        if(latency > max_latency) max_latency = latency;
+        total_latency += latency;
+        fired++;
+
+        dispatch(slot - slots);
+    }
+
+    // Run any other timers that are due. Timers set by callbacks run on a later call.
+    uint8_t runs = heap_size;
+    while(runs-- && heap_size && (int32_t)(now - slots[heap[0]].due) >= 0){
+        dispatch(heap[0]);
+    }
+}
+
+/**
+ * @return time until the next timer is due (ms), 0 if one is due, or UINT32_MAX if no timers
+ *  are set (triggers don't count)
+ **/
+uint32_t Scheduler::time_to_next(){
+    if(ready_tail != ready_head) return 0;
+    if(heap_size == 0) return UINT32_MAX;
+    int32_t left = slots[heap[0]].due - clock_millis();
+    return left > 0 ? left : 0;
+}
+
+/**
+ * @return timers run after being seen by the interrupt
+ **/
+uint32_t Scheduler::get_fired(){
+    return fired;
+}
+
+/**
+ * @return most time between a timer's deadline and the interrupt seeing it (ms)
+ **/
+uint32_t Scheduler::get_max_jitter(){
+    return max_jitter;
+}
+
+/**
+ * @return most time between the interrupt seeing a timer and the loop running it (us)
+ **/
+uint32_t Scheduler::get_max_latency(){
+    return max_latency;
+}
+
+/**
+ * @return mean time between the interrupt seeing a timer and the loop running it (us)
+ **/
+uint32_t Scheduler::get_mean_latency(){
+    if(fired == 0) return 0;
+    return total_latency / fired;
+}
+
+/**
+ * Hardware timer interrupt: queue the earliest timer once it expires
+ * @return CPU cycles until the next check
+ **/
+uint32_t IRAM_ATTR Scheduler::isr(){
+    Timer_Handle handle = scheduler.armed_handle;
+    if(handle != TIMER_NONE && (int32_t)(millis() - scheduler.armed_due) >= 0){
+        uint8_t head = scheduler.ready_head;
+        uint8_t next = (head + 1) % SCHEDULER_READY_SIZE;
+        // If the queue is full the loop still finds the timer by polling
+        if(next != scheduler.ready_tail){
+            scheduler.ready[head] = {handle, millis(), micros()};
+            scheduler.ready_head = next;
+        }
+        scheduler.armed_handle = TIMER_NONE;
+    }
+    return microsecondsToClockCycles(SCHEDULER_ISR_PERIOD);
+}
+
+/**
+ * Point the interrupt at the earliest timer (call whenever the heap changes)
+ **/
+void Scheduler::arm(){
+    if(heap_size == 0){
+        armed_handle = TIMER_NONE;
+        return;
+    }
+    uint8_t slot = heap[0];
+    Timer_Handle handle = ((slots[slot].generation & 0xFFFFFF) << 8) | (slot + 1);
+    if(handle == armed_handle) return;
+
+    // The interrupt may see the new deadline with the old handle, which handle() rejects
+    armed_due = slots[slot].due;
+    armed_handle = handle;
+}
+
+/**
+ * Remove a due timer from the heap and run it
+ * @param slot number
+ **/
+void Scheduler::dispatch(uint8_t slot){
+    void_function_pointer callback = slots[slot].callback;
+    heap_remove(slots[slot].heap_index);
+    release(slot);
+    arm();
+    callback();
+}
+
+/**
+ * Take a free slot
+ * @param callback void function to call
+ * @return handle of slot, or TIMER_NONE if all slots are in use
+ **/
+Timer_Handle Scheduler::allocate(void_function_pointer callback){
+    for(uint8_t i = 0; i < SCHEDULER_SLOTS; i++){
+        if(!slots[i].active){
+            slots[i].active = true;
+            slots[i].callback = callback;
+            slots[i].heap_index = SCHEDULER_SLOTS;
+            return ((slots[i].generation & 0xFFFFFF) << 8) | (i + 1);
+        }
+    }
+    return TIMER_NONE;
+}
+
+/**
+ * @param handle of timer or trigger
+ * @return its slot, or NULL if the handle is stale
+ **/
+Scheduler::Slot* Scheduler::find(Timer_Handle handle){
+    uint8_t index = handle & 0xFF;
+    if(index == 0 || index > SCHEDULER_SLOTS) return NULL;
+
+    Slot* slot = &slots[index - 1];
+    if(!slot->active || (slot->generation & 0xFFFFFF) != (handle >> 8)) return NULL;
+    return slot;
+}
+
+/**
+ * Free a slot and make any handles to it stale
+ * @param slot number
+ **/
+void Scheduler::release(uint8_t slot){
+    slots[slot].active = false;
+    slots[slot].generation++;
+}
+
+/**
+ * @return true if slot a is due before slot b
+ **/
+bool Scheduler::before(uint8_t a, uint8_t b){
+    return (int32_t)(slots[a].due - slots[b].due) < 0;
+}
+
+/**
+ * Swap two heap entries
+ **/
+void Scheduler::heap_swap(uint8_t i, uint8_t j){
+    uint8_t temp = heap[i];
+    heap[i] = heap[j];
+    heap[j] = temp;
+    slots[heap[i]].heap_index = i;
+    slots[heap[j]].heap_index = j;
+}
+
+/**
+ * Add a slot to the heap
+ * @param slot number
+ **/
+void Scheduler::heap_push(uint8_t slot){
+    heap[heap_size] = slot;
+    slots[slot].heap_index = heap_size;
+    sift_up(heap_size++);
+}
+
+/**
+ * Remove an entry from the heap
+ * @param index in heap
+ **/
+void Scheduler::heap_remove(uint8_t index){
+    uint8_t last = --heap_size;
+    slots[heap[index]].heap_index = SCHEDULER_SLOTS;
+    if(index == last) return;
+
+    uint8_t moved = heap[last];
+    heap[index] = moved;
+    slots[moved].heap_index = index;
+    sift_up(index);
+    sift_down(slots[moved].heap_index);
+}
+
+/**
+ * Move an entry up the heap until its parent is due first
+ **/
+void Scheduler::sift_up(uint8_t index){
+    while(index > 0){
+        uint8_t parent = (index - 1) / 2;
+        if(!before(heap[index], heap[parent])) return;
+        heap_swap(index, parent);
+        index = parent;
+    }
+}
+
+/**
+ * Move an entry down the heap until its children are due after it
+ **/
+void Scheduler::sift_down(uint8_t index){
+    while(true){
+        uint8_t first = index;
+        uint8_t left = index * 2 + 1;
+        uint8_t right = left + 1;
+        if(left < heap_size && before(heap[left], heap[first])) first = left;
+        if(right < heap_size && before(heap[right], heap[first])) first = right;
+        if(first == index) return;
+        heap_swap(index, first);
+        index = first;
+    }
+}
+
+/**
+ * Set a trigger, replacing whatever this timer held
+ * @param callback void function to call
+ **/
+void Soft_Timer::set_trigger(void_function_pointer callback){
+    scheduler.cancel(handle);
+    handle = scheduler.set_trigger(callback);
+}
+
+/**
+ * Set a timer, replacing whatever this timer held
+ * @param callback void function to call
+ * @param time from now to call function (ms)
+ **/
+void Soft_Timer::set_timer(void_function_pointer callback, uint32_t time){
+    scheduler.cancel(handle);
+    handle = scheduler.set_timer(callback, time);
+}
+
+/**
+ * Set a timer for an absolute time, replacing whatever this timer held
+ * @param callback void function to call
+ * @param due time to call function (ms, as clock_millis())
+ **/
+void Soft_Timer::set_timer_at(void_function_pointer callback, uint32_t due){
+    scheduler.cancel(handle);
+    handle = scheduler.set_timer_at(callback, due);
+}
+
+/**
+ * Run the trigger now if it's set
+ **/
+void Soft_Timer::trigger(){
+    Timer_Handle current = handle;
+    handle = TIMER_NONE;
+    scheduler.trigger(current);
+}
+
+/**
+ * Remove the timer or trigger
+ **/
+void Soft_Timer::remove(){
+    scheduler.cancel(handle);
+    handle = TIMER_NONE;
+}
+
+/**
+ * @return true if the timer or trigger hasn't run or been removed yet
+ **/
+bool Soft_Timer::pending(){
+    return scheduler.pending(handle);
+}
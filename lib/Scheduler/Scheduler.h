@@ -0,0 +1,139 @@
+/**
+ * Scheduler Library
+ * Runs many independent timers (call a function after some time) and triggers (call a 
+ * function when triggered). Timers are kept in a min-heap ordered by deadline, so handle() 
+ * costs one comparison when nothing is due. Deadlines are compared as signed differences, so 
+ * timers keep working across the millis() wraparound as long as none is set more than 24 
+ * days ahead.
+ * 
+ * Each timer or trigger is referred to by a handle. Handles are tagged with a generation, so 
+ * a handle to a timer that already ran or was cancelled is ignored rather than acting on 
+ * whatever now uses its slot.
+ * 
+ * The earliest timer is also watched from the hardware timer interrupt (timer1, shared with 
+ * tone() and analogWrite()), which timestamps the moment it expires and queues it for the 
+ * loop. Callbacks always run from handle(), but how late the interrupt saw each timer 
+ * (jitter) and how long the loop took to run it after that (latency) are both measured.
+ * 
+ * Run begin() once, then the handle() function on each loop or as often as possible for 
+ * correct timing.
+ **/
+#include "Arduino.h"
+#include "Clock.h"
+
+// Maximum number of timers and triggers at once
+#define SCHEDULER_SLOTS 16
+
+// Handle that never refers to a timer
+#define TIMER_NONE 0
+
+// Expired timers the interrupt can queue before the loop drains them
+#define SCHEDULER_READY_SIZE 8
+// Time between checks in the interrupt (us)
+#define SCHEDULER_ISR_PERIOD 500
+
+typedef void (*void_function_pointer)();
+typedef uint32_t Timer_Handle;
+
+class Scheduler{
+
+    public:
+
+        Scheduler();
+
+        Timer_Handle
+            set_timer(void_function_pointer, uint32_t),
+            set_timer_at(void_function_pointer, uint32_t),
+            set_trigger(void_function_pointer);
+
+        bool
+            trigger(Timer_Handle),
+            cancel(Timer_Handle),
+            pending(Timer_Handle);
+
+        void 
+            begin(),
+            handle();
+
+        uint32_t
+            time_to_next(),
+            get_fired(),
+            get_max_jitter(),
+            get_max_latency(),
+            get_mean_latency();
+
+    private:
+
+        struct Slot{
+            void_function_pointer callback;
+            uint32_t due;
+            uint32_t generation;     // Counts reuses of the slot (24 bits are kept in handles)
+            uint8_t heap_index;     // Position in the heap, or SCHEDULER_SLOTS for triggers
+            bool active;
+        };
+
+        // Timer expiry seen by the interrupt
+        struct Ready{
+            Timer_Handle handle;
+            uint32_t fired_ms;
+            uint32_t fired_us;
+        };
+
+        Slot slots[SCHEDULER_SLOTS];
+        uint8_t heap[SCHEDULER_SLOTS];
+        uint8_t heap_size = 0;
+
+        // Earliest timer, watched by the interrupt (handle written last)
+        volatile uint32_t armed_due = 0;
+        volatile Timer_Handle armed_handle = TIMER_NONE;
+
+        // Single producer (interrupt), single consumer (loop) queue of expired timers
+        Ready ready[SCHEDULER_READY_SIZE];
+        volatile uint8_t ready_head = 0;
+        volatile uint8_t ready_tail = 0;
+
+        // Timers run from the queue (ms late when the interrupt saw them, us until run)
+        uint32_t fired = 0;
+        uint32_t max_jitter = 0;
+        uint32_t max_latency = 0;
+        uint64_t total_latency = 0;
+
+        static uint32_t isr();
+        void arm();
+        void dispatch(uint8_t slot);
+
+        Timer_Handle allocate(void_function_pointer);
+        Slot* find(Timer_Handle);
+        void release(uint8_t slot);
+
+        bool before(uint8_t a, uint8_t b);
+        void heap_swap(uint8_t i, uint8_t j);
+        void heap_push(uint8_t slot);
+        void heap_remove(uint8_t index);
+        void sift_up(uint8_t index);
+        void sift_down(uint8_t index);
+};
+
+extern Scheduler scheduler;
+
+/**
+ * A single timer or trigger owned by one subsystem. Setting it again replaces what it held,
+ * without touching any other timer.
+ **/
+class Soft_Timer{
+
+    public:
+
+        void 
+            set_trigger(void_function_pointer),
+            set_timer(void_function_pointer, uint32_t),
+            set_timer_at(void_function_pointer, uint32_t),
+            trigger(),
+            remove();
+
+        bool pending();
+
+    private:
+
+        Timer_Handle handle = TIMER_NONE;
+};
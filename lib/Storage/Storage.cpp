@@ -0,0 +1,321 @@
+/**
+ * Storage Library
+ * The file system that settings and web files are kept in. SPIFFS by default, LittleFS when
+ * built with -D STORAGE_LITTLEFS, or a file system in RAM that starts empty when built with
+ * -D STORAGE_RAM.
+ *
+ * The RAM file system keeps each file in a vector, looked up by its full path. It's lost on
+ * restart, has no real directories and holds at most STORAGE_RAM_SIZE bytes of contents, so
+ * it's for timing the code above it and for running without wearing the flash.
+ **/
+#include "Storage.h"
+
+#if defined(STORAGE_RAM)
+
+#include "FSImpl.h"
+#include <map>
+#include <memory>
+#include <vector>
+
+typedef std::shared_ptr<std::vector<uint8_t>> Ram_Data;
+typedef std::map<String, Ram_Data> Ram_Files;
+
+/**
+ * @param files to add up
+ * @return bytes of contents in all the files
+ **/
+size_t ram_used(const Ram_Files& files){
+    size_t used = 0;
+    for(auto& file : files) used += file.second->size();
+    return used;
+}
+
+class Ram_File_Impl : public fs::FileImpl{
+    public:
+
+        /**
+         * Constructor
+         * @param files in the file system, to keep within STORAGE_RAM_SIZE
+         * @param path of the file
+         * @param data contents of the file, shared with the file system
+         * @param open_mode create, append or truncate flags the file was opened with
+         * @param access_mode read and write flags the file was opened with
+         **/
+        Ram_File_Impl(const Ram_Files& files, const String& path, Ram_Data data,
+            fs::OpenMode open_mode, fs::AccessMode access_mode) :
+            _files(files), _path(path), _data(data){
+            _read = access_mode & fs::AM_READ;
+            _write = access_mode & fs::AM_WRITE;
+            _append = open_mode & fs::OM_APPEND;
+            _name = strrchr(_path.c_str(), '/');
+            _name = _name ? _name + 1 : _path.c_str();
+        }
+
+        size_t write(const uint8_t* buf, size_t size) override{
+            if(!_open || !_write) return 0;
+            if(_append) _pos = _data->size();
+
+            //Only the bytes past the end take up more room
+            size_t grow = _pos + size > _data->size() ? _pos + size - _data->size() : 0;
+            size_t room = STORAGE_RAM_SIZE - min(ram_used(_files), (size_t)STORAGE_RAM_SIZE);
+            if(grow > room) size -= grow - room;
+
+            if(_pos + size > _data->size()) _data->resize(_pos + size);
+            memcpy(_data->data() + _pos, buf, size);
+            _pos += size;
+            return size;
+        }
+
+        int read(uint8_t* buf, size_t size) override{
+            if(!_open || !_read) return -1;
+            size = _pos < _data->size() ? min(size, _data->size() - _pos) : 0;
+            memcpy(buf, _data->data() + _pos, size);
+            _pos += size;
+            return size;
+        }
+
+        void flush() override{}
+
+        bool seek(uint32_t pos, fs::SeekMode mode) override{
+            if(!_open) return false;
+            size_t size = _data->size();
+
+            //Check offsets against the room left before adding, so they can't wrap around
+            if(mode == fs::SeekCur){
+                if(pos > size - min(_pos, size)) return false;
+                pos += _pos;
+            }else if(mode == fs::SeekEnd){
+                if(pos > size) return false;
+                pos = size - pos;
+            }
+            if(pos > size) return false;
+            _pos = pos;
+            return true;
+        }
+
+        size_t position() const override{
+            return _pos;
+        }
+
+        size_t size() const override{
+            return _data->size();
+        }
+
+        bool truncate(uint32_t size) override{
+            if(!_open || !_write || size > _data->size()) return false;
+            _data->resize(size);
+            _pos = min(_pos, (size_t)size);
+            return true;
+        }
+
+        void close() override{
+            _open = false;
+        }
+
+        const char* name() const override{
+            return _name;
+        }
+
+        const char* fullName() const override{
+            return _path.c_str();
+        }
+
+        bool isFile() const override{
+            return true;
+        }
+
+        bool isDirectory() const override{
+            return false;
+        }
+
+    private:
+        const Ram_Files& _files;
+        String _path;
+        const char* _name;
+        Ram_Data _data;
+        size_t _pos = 0;
+        bool _open = true;
+        bool _read, _write, _append;
+};
+
+class Ram_FS_Impl;
+
+class Ram_Dir_Impl : public fs::DirImpl{
+    public:
+
+        /**
+         * Constructor
+         * @param fs to open files from
+         * @param paths of the files in the directory
+         **/
+        Ram_Dir_Impl(Ram_FS_Impl& fs, std::vector<String> paths) : _fs(fs), _paths(paths){}
+
+        fs::FileImplPtr openFile(fs::OpenMode open_mode, fs::AccessMode access_mode) override;
+
+        const char* fileName() override{
+            return valid() ? _paths[_index].c_str() : "";
+        }
+
+        size_t fileSize() override;
+
+        bool isFile() const override{
+            return valid();
+        }
+
+        bool isDirectory() const override{
+            return false;
+        }
+
+        bool next() override{
+            if(_index < (int)_paths.size()) _index++;
+            return valid();
+        }
+
+        bool rewind() override{
+            _index = -1;
+            return true;
+        }
+
+    private:
+        Ram_FS_Impl& _fs;
+        std::vector<String> _paths;
+        int _index = -1;
+
+        bool valid() const{
+            return _index >= 0 && _index < (int)_paths.size();
+        }
+};
+
+class Ram_FS_Impl : public fs::FSImpl{
+    public:
+
+        bool setConfig(const fs::FSConfig&) override{
+            return true;
+        }
+
+        bool begin() override{
+            return true;
+        }
+
+        void end() override{}
+
+        bool format() override{
+            _files.clear();
+            return true;
+        }
+
+        bool info(fs::FSInfo& info) override{
+            info.totalBytes = STORAGE_RAM_SIZE;
+            info.usedBytes = ram_used(_files);
+            info.blockSize = 256;
+            info.pageSize = 256;
+            info.maxOpenFiles = 255;
+            info.maxPathLength = 32;
+            return true;
+        }
+
+        bool info64(fs::FSInfo64& info) override{
+            info.totalBytes = STORAGE_RAM_SIZE;
+            info.usedBytes = ram_used(_files);
+            info.blockSize = 256;
+            info.pageSize = 256;
+            info.maxOpenFiles = 255;
+            info.maxPathLength = 32;
+            return true;
+        }
+
+        fs::FileImplPtr open(const char* path, fs::OpenMode open_mode,
+            fs::AccessMode access_mode) override{
+            auto file = _files.find(path);
+            if(file == _files.end()){
+                if(!(open_mode & fs::OM_CREATE)) return fs::FileImplPtr();
+                file = _files.emplace(path, std::make_shared<std::vector<uint8_t>>()).first;
+            }
+            if(open_mode & fs::OM_TRUNCATE) file->second->clear();
+            return std::make_shared<Ram_File_Impl>(_files, file->first, file->second,
+                open_mode, access_mode);
+        }
+
+        bool exists(const char* path) override{
+            return _files.count(path);
+        }
+
+        fs::DirImplPtr openDir(const char* path) override{
+            String prefix = path;
+            if(!prefix.endsWith("/")) prefix += "/";
+            std::vector<String> paths;
+            for(auto& file : _files){
+                if(file.first.startsWith(prefix)) paths.push_back(file.first);
+            }
+            return std::make_shared<Ram_Dir_Impl>(*this, paths);
+        }
+
+        bool rename(const char* from, const char* to) override{
+            auto file = _files.find(from);
+            if(file == _files.end() || _files.count(to)) return false;
+            Ram_Data data = file->second;
+            _files.erase(file);
+            _files.emplace(to, data);
+            return true;
+        }
+
+        bool remove(const char* path) override{
+            return _files.erase(path);
+        }
+
+        bool mkdir(const char*) override{
+            return true;
+        }
+
+        bool rmdir(const char*) override{
+            return true;
+        }
+
+        /**
+         * @param path of a file
+         * @return its size (bytes), or 0 if it doesn't exist
+         **/
+        size_t size_of(const String& path){
+            auto file = _files.find(path);
+            return file == _files.end() ? 0 : file->second->size();
+        }
+
+    private:
+        Ram_Files _files;
+};
+
+fs::FileImplPtr Ram_Dir_Impl::openFile(fs::OpenMode open_mode, fs::AccessMode access_mode){
+    return valid() ? _fs.open(_paths[_index].c_str(), open_mode, access_mode) :
+        fs::FileImplPtr();
+}
+
+size_t Ram_Dir_Impl::fileSize(){
+    return valid() ? _fs.size_of(_paths[_index]) : 0;
+}
+
+fs::FS ram_fs(fs::FSImplPtr(new Ram_FS_Impl()));
+fs::FS& storage = ram_fs;
+
+#elif defined(STORAGE_LITTLEFS)
+
+#include "LittleFS.h"
+
+fs::FS& storage = LittleFS;
+
+#else
+
+fs::FS& storage = SPIFFS;
+
+#endif
+
+bool storage_mounted = false;
+
+/**
+ * Mount the file system, if it isn't already. Not safe to call from a global constructor,
+ * as the file system may not be constructed yet.
+ * @return true if the file system is mounted
+ **/
+bool storage_begin(){
+    if(!storage_mounted) storage_mounted = storage.begin();
+    return storage_mounted;
+}
@@ -0,0 +1,16 @@
+/**
+ * Storage Library
+ * The file system that settings and web files are kept in. SPIFFS by default, LittleFS when
+ * built with -D STORAGE_LITTLEFS, or a file system in RAM that starts empty when built with
+ * -D STORAGE_RAM.
+ * 
+ * Use storage in place of SPIFFS, and call storage_begin() before the first file is opened.
+ **/
+#include "Arduino.h"
+#include "FS.h"
+
+#define STORAGE_RAM_SIZE 16384 //Most bytes of file contents in the RAM file system
+
+extern fs::FS& storage;
+
+bool storage_begin();
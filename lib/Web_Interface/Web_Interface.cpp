@@ -5,10 +5,10 @@
 
     To use, initialize a Web_Interface setting and call handle() every loop or as
     often as possible. Call console_print() to output a line to the console. Place
-    files for server in /www/ folder in SPIFFS. 
+    files for server in /www/ folder in the file system. 
 
     To use the settings function, place a settings.txt file in the root 
-    of the SPIFFS. Settings must be in the following JSON format ("advanced" is
+    of the file system. Settings must be in the following JSON format ("advanced" is
     an optional category, while "basic" and "wifi" are required and can have any
     number of settings):
     {"basic":[
@@ -54,6 +54,8 @@ const String settings_path = "/settings.txt"; //Path to settings file
 
 File upload_file; //Holds file currently uploading
 
+restart_function restart_callback = NULL; //Called before the ESP restarts
+
 //settings
 const bool settings_page = true;
 const uint8_t number_custom_pages = 0;
@@ -79,7 +81,7 @@ String get_content_type(String filename){
     return "text/plain"; //If none of the above, assume file is plain text
 }
 
-/*  (private)handle_file_read: Read a file from SPIFFS and serve it when requested.
+/*  (private)handle_file_read: Read a file from the file system and serve it when requested.
         path: The requested URI
     RETURNS true if the file exists, false if it does not exist
 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
@@ -99,8 +101,8 @@ bool handle_file_read(String path){
     } 
 
     //If the compressed file exists, stream it to the client
-    if(SPIFFS.exists(path + ".gz")){
-        File file = SPIFFS.open(path + ".gz", "r"); 
+    if(storage.exists(path + ".gz")){
+        File file = storage.open(path + ".gz", "r"); 
         if(cache) server.sendHeader("Cache-Control", "max-age=2592000");          
         server.streamFile(file, content_type);
         file.close();                                    
@@ -108,8 +110,8 @@ bool handle_file_read(String path){
     }
 
     //If the file exists, stream it to the client
-    if(SPIFFS.exists(path)){
-        File file = SPIFFS.open(path, "r");
+    if(storage.exists(path)){
+        File file = storage.open(path, "r");
         if(cache) server.sendHeader("Cache-Control", "max-age=2592000"); 
         server.streamFile(file, content_type);
         file.close();                                    
@@ -117,8 +119,8 @@ bool handle_file_read(String path){
     }
 
     //If the file exists in the root folder instead of the /www/ folder, stream it to the client (this is for debugging non-server files)
-    if(SPIFFS.exists(path.substring(4))){
-        File file = SPIFFS.open(path.substring(4), "r");                
+    if(storage.exists(path.substring(4))){
+        File file = storage.open(path.substring(4), "r");                
         server.streamFile(file, content_type);
         file.close();                                    
         return true;
@@ -249,11 +251,12 @@ String input_html(JsonArray settings){
     return response;
 }
 
-/*  (private)handle_settings_get: Send the settings to the browser as an HTML form
+/*  (private)build_settings_html: Build the settings HTML form
+    RETURNS The settings form, or an error message if the settings file is invalid
 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
-void handle_settings_get(){
+String build_settings_html(){
     //Open the settings file
-    File file = SPIFFS.open(settings_path, "r");
+    File file = storage.open(settings_path, "r");
     //Set aside enough memory for a JSON document
     DynamicJsonDocument doc(file.size() * 2);
 
@@ -263,10 +266,9 @@ void handle_settings_get(){
     //Close the file
     file.close();
 
-    //If there is an error, send the response to the browser and exit the function
+    //If there is an error, return the error message
     if(error){
-        server.send(200, "text/html", "<h3>Invalid settings file or no settings defined!</h3>");
-        return;
+        return "<h3>Invalid settings file or no settings defined!</h3>";
     } 
 
     //Store whether the settings category exists or not
@@ -314,8 +316,20 @@ void handle_settings_get(){
     //End the settings form
     response += "</div>";
 
-    //Send the response to the browser
-    server.send(200, "text/html", response);
+    return response;
+}
+
+/*  (private)handle_settings_get: Send the settings to the browser as an HTML form
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+void handle_settings_get(){
+    server.send(200, "text/html", build_settings_html());
+}
+
+/*  (private)restart: Let the application save its state, then restart the ESP
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+void restart(){
+    if(restart_callback != NULL) restart_callback();
+    ESP.restart();
 }
 
 /*  (private)handle_settings_post: Receive new settings from the browser
@@ -325,7 +339,7 @@ void handle_settings_post(){
     server.send(200);
 
     //Open the file for reading
-    File file = SPIFFS.open(settings_path, "r");
+    File file = storage.open(settings_path, "r");
     //Set aside enough memory for a JSON document
     DynamicJsonDocument doc(file.size() * 2);
 
@@ -365,13 +379,13 @@ void handle_settings_post(){
 
 
     //Open the file for writing
-    file = SPIFFS.open(settings_path, "w");
+    file = storage.open(settings_path, "w");
     //Encode the JSON in the file
     serializeJson(doc, file);
     //Close the file
     file.close();
 
-    ESP.restart();
+    restart();
 }
 
 /*  (private)handle_nav: Send the navigation bar to the browser as a dynamically-generated navbar
@@ -400,14 +414,32 @@ void handle_nav(){
     server.send(200, "text/html", response);
 }
 
+/*  (private)Chunked_Print: Sends everything printed to it as chunks of the current
+    response, so pages can be generated without building them in a String
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+class Chunked_Print : public Print{
+    public:
+        size_t write(uint8_t c) override{
+            buffer[length++] = c;
+            if(length == sizeof(buffer)) flush();
+            return 1;
+        }
+
+        void flush() override{
+            if(length) server.sendContent(buffer, length);
+            length = 0;
+        }
+
+    private:
+        char buffer[256];
+        size_t length = 0;
+};
+
 /*  Web_Interface Constructor (with defaults)
 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
-Web_Interface::Web_Interface(){
-    SPIFFS.begin();
-    SPIFFS.gc();
-}
+Web_Interface::Web_Interface(){}
 
-/*  (private)handle_file_upload: Processes file upload and saves it to SPIFFS
+/*  (private)handle_file_upload: Processes file upload and saves it to the file system
 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
 void handle_file_upload(){
     //Holds current upload
@@ -419,7 +451,7 @@ void handle_file_upload(){
         //Add a / prefix if it's not part of the filename already
         if(!filename.startsWith("/")) filename = "/" + filename;
         //Open the file for writing
-        upload_file = SPIFFS.open(filename, "w");   
+        upload_file = storage.open(filename, "w");   
     //If the upload is in progress, write the buffer to the file        
     }else if(upload.status == UPLOAD_FILE_WRITE && upload_file){
         upload_file.write(upload.buf, upload.currentSize);
@@ -430,7 +462,7 @@ void handle_file_upload(){
         if(upload_file) upload_file.close();
         //If the settings file was uploaded, restart the ESP
         if(upload.filename == "settings.txt"){
-            ESP.restart();
+            restart();
         } 
     }
 
@@ -441,6 +473,10 @@ void handle_file_upload(){
     RETURNS True if the settings file is good, false if it's missing anything
 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
 void Web_Interface::begin(){
+    //Mount and tidy up the file system here rather than in the constructor, which runs before
+    //setup() and possibly before the file system is constructed
+    storage_begin();
+    storage.gc();
 
     //When the settings file is requested or posted, call the corresponding function
     server.on("/settings_data", HTTP_POST, handle_settings_post);
@@ -449,7 +485,7 @@ void Web_Interface::begin(){
     //When a POST is requested from /upload, send status 200 to initiate upload and call handle_file_upload function repeatedly
     server.on("/upload", HTTP_POST, [](){ server.send(200); }, handle_file_upload );
 
-    server.on("/restart", HTTP_GET, [](){ server.send(200); ESP.restart(); });
+    server.on("/restart", HTTP_GET, [](){ server.send(200); restart(); });
 
 
     //If any other file is requested, send it if it exists or send a generic 404 if it doesn't exist
@@ -462,9 +498,9 @@ void Web_Interface::begin(){
     server.begin(); //Start the server
 
     // If the settings file does not exist, copy it from the default settings file
-    if(!SPIFFS.exists(settings_path)){
-        File settings_def = SPIFFS.open("/settings_def.txt", "r");
-        File settings = SPIFFS.open(settings_path, "w");
+    if(!storage.exists(settings_path)){
+        File settings_def = storage.open("/settings_def.txt", "r");
+        File settings = storage.open(settings_path, "w");
         while(settings_def.available()){
             settings.write(settings_def.read());
         }
@@ -474,6 +510,40 @@ void Web_Interface::begin(){
 
 }
 
+/*  add_page: Serve a generated page
+        uri: Path of the page
+        content_type: MIME type of the page
+        page: Function that prints the page
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+void Web_Interface::add_page(const String& uri, const char* content_type, page_function page){
+    server.on(uri, HTTP_GET, [content_type, page](){
+        server.sendHeader("Cache-Control", "no-cache");
+        server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        server.send(200, content_type, "");
+
+        Chunked_Print out;
+        page(out);
+        out.flush();
+        //An empty chunk ends the response
+        server.sendContent("");
+    });
+}
+
+/*  set_restart_callback: Set a function to call before the web interface restarts the
+    ESP, e.g. to save state that is written in the background
+        callback: Function to call
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+void Web_Interface::set_restart_callback(restart_function callback){
+    restart_callback = callback;
+}
+
+/*  settings_html: 
+    RETURNS The settings page form, as sent to the browser
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+String Web_Interface::settings_html(){
+    return build_settings_html();
+}
+
 /*  handle: Check for incoming requests to the server and to the websockets server
 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
 void Web_Interface::handle(){
@@ -485,7 +555,7 @@ void Web_Interface::handle(){
 ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
 String Web_Interface::load_setting(String setting){
     //Open the file for reading
-    File file = SPIFFS.open(settings_path, "r");
+    File file = storage.open(settings_path, "r");
     //Set aside enough memory for a JSON document
     DynamicJsonDocument doc(file.size() * 2);
 
@@ -525,4 +595,39 @@ String Web_Interface::load_setting(String setting){
     //If nothin has been returned so far, return an empty string
     return "";     
 
+}
+
+/*  load_settings: Parse the settings file once and pass every setting to a callback. Use
+    this instead of load_setting() when reading more than one setting.
+        callback: Function called with the id and value of each setting
+    RETURNS True if the settings file was parsed, false if not
+~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+bool Web_Interface::load_settings(setting_function callback){
+    //Open the file for reading
+    File file = storage.open(settings_path, "r");
+    //Set aside enough memory for a JSON document
+    DynamicJsonDocument doc(file.size() * 2);
+
+    //Parse JSON from file
+    DeserializationError error = deserializeJson(doc, file);
+    //Close the file
+    file.close();
+    //If there is an error, there are no settings to load
+    if(error){
+        return false;
+    } 
+
+    //Cycle through each setting category
+    for(JsonPair category : doc.as<JsonObject>()){
+        JsonArray settings = category.value();
+        //For each setting...
+        for(int i = 0; i < settings.size(); i++){
+            //Pass the id and value (blank if not set) to the callback
+            String val = "";
+            if(!settings[i]["val"].isNull()) val = settings[i]["val"].as<String>();
+            callback(settings[i]["id"].as<String>(), val);
+        }
+    }
+
+    return true;
 }
\ No newline at end of file
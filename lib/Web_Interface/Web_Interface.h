@@ -1,8 +1,12 @@
 #include "Arduino.h"
 #include "ESP8266WebServer.h" //Web Server Library
-#include "fs.h" //SPIFFS Library
+#include "Storage.h" //File system the web files and settings are kept in
 #include "ArduinoJson.h" //Arduino JavaScript Object Notation Library
 
+typedef void (*setting_function)(const String& id, const String& val);
+typedef void (*page_function)(Print& out);
+typedef void (*restart_function)();
+
 class Web_Interface{
     public:
     
@@ -13,6 +17,14 @@ class Web_Interface{
             begin();
             
         String
-            load_setting(String setting);
+            load_setting(String setting),
+            settings_html();
+
+        bool
+            load_settings(setting_function callback);
+
+        void
+            add_page(const String& uri, const char* content_type, page_function page),
+            set_restart_callback(restart_function callback);
         
 };
\ No newline at end of file
@@ -0,0 +1,49 @@
+/**
+ * Arduino Shim
+ * Adafruit NeoPixel strip that records frames instead of sending them. Showing one keeps
+ * interrupts off for as long as the bit-bang driver would (see native_interrupts_off()).
+ **/
+#include "Adafruit_NeoPixel.h"
+#include "Arduino.h"
+#include "Native.h"
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, int16_t pin, neoPixelType type) :
+    _num_pixels(n), _pin(pin), _pixels(n * 3), _shown(n * 3){
+    _r_offset = (type >> 4) & 0b11;
+    _g_offset = (type >> 2) & 0b11;
+    _b_offset = type & 0b11;
+}
+
+void Adafruit_NeoPixel::begin(){
+    pinMode(_pin, OUTPUT);
+    digitalWrite(_pin, LOW);
+}
+
+void Adafruit_NeoPixel::show(){
+    // Bit-banged with interrupts off, 24 bits of 1.25us per pixel
+    native_interrupts_off(_num_pixels * 30);
+    _shown = _pixels;
+    _show_count++;
+}
+
+void Adafruit_NeoPixel::clear(){
+    std::fill(_pixels.begin(), _pixels.end(), 0);
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b){
+    if(n >= _num_pixels) return;
+    uint8_t* p = &_pixels[n * 3];
+    p[_r_offset] = r;
+    p[_g_offset] = g;
+    p[_b_offset] = b;
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint32_t c){
+    setPixelColor(n, c >> 16, c >> 8, c);
+}
+
+uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t n) const{
+    if(n >= _num_pixels) return 0;
+    const uint8_t* p = &_pixels[n * 3];
+    return Color(p[_r_offset], p[_g_offset], p[_b_offset]);
+}
@@ -0,0 +1,57 @@
+/**
+ * Arduino Shim
+ * Adafruit NeoPixel strip that records frames instead of sending them: show() copies the
+ * pixel buffer to shown() and counts the frames. Interrupts are off for as long as sending the
+ * frame would take, so UART1 is starved just as on the device.
+ **/
+#ifndef ADAFRUIT_NEOPIXEL_SHIM_H
+#define ADAFRUIT_NEOPIXEL_SHIM_H
+
+#include <stdint.h>
+#include <vector>
+
+// Offsets of red, green and blue in each pixel (same values as the library)
+#define NEO_RGB     ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_RBG     ((0 << 6) | (0 << 4) | (2 << 2) | (1))
+#define NEO_GRB     ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_GBR     ((2 << 6) | (2 << 4) | (0 << 2) | (1))
+#define NEO_BRG     ((1 << 6) | (1 << 4) | (2 << 2) | (0))
+#define NEO_BGR     ((2 << 6) | (2 << 4) | (1 << 2) | (0))
+#define NEO_KHZ800  0x0000
+#define NEO_KHZ400  0x0100
+
+typedef uint16_t neoPixelType;
+
+class Adafruit_NeoPixel{
+    public:
+        Adafruit_NeoPixel(uint16_t n, int16_t pin = 6, neoPixelType type = NEO_GRB + NEO_KHZ800);
+
+        void begin();
+        void show();
+        bool canShow(){ return true; }
+        void clear();
+
+        void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+        void setPixelColor(uint16_t n, uint32_t c);
+        uint32_t getPixelColor(uint16_t n) const;
+        uint8_t* getPixels(){ return _pixels.data(); }
+        uint16_t numPixels() const{ return _num_pixels; }
+        int16_t getPin() const{ return _pin; }
+
+        static uint32_t Color(uint8_t r, uint8_t g, uint8_t b){
+            return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+        }
+
+        const std::vector<uint8_t>& shown() const{ return _shown; }
+        uint32_t show_count() const{ return _show_count; }
+
+    private:
+        uint16_t _num_pixels;
+        int16_t _pin;
+        uint8_t _r_offset, _g_offset, _b_offset;
+        std::vector<uint8_t> _pixels;
+        std::vector<uint8_t> _shown;
+        uint32_t _show_count = 0;
+};
+
+#endif
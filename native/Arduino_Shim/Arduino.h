@@ -0,0 +1,84 @@
+/**
+ * Arduino Shim
+ * Just enough of the ESP8266 Arduino core to build the timer for the host ([env:native]), so
+ * the tests, benchmarks and match simulator in test/ run without a board:
+ *  -millis()/micros() count real time from the start of the program
+ *  -Pins are an array (inputs read HIGH until set with native_set_pin())
+ *  -Serial prints to stdout
+ *  -SPIFFS and LittleFS are a temporary directory (see FS.h)
+ *  -Adafruit_NeoPixel and UART1 record what is sent to them (see Native.h)
+ **/
+#ifndef ARDUINO_SHIM_H
+#define ARDUINO_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "pgmspace.h"
+#include "esp8266_peri.h"
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+#include "Esp.h"
+
+using std::min;
+using std::max;
+
+#define F_CPU 160000000L
+
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+
+#define HIGH    0x1
+#define LOW     0x0
+
+#define INPUT           0x00
+#define INPUT_PULLUP    0x02
+#define OUTPUT          0x01
+
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define NUM_DIGITAL_PINS 17
+
+#define clockCyclesPerMicrosecond() (F_CPU / 1000000L)
+#define microsecondsToClockCycles(a) ((a) * clockCyclesPerMicrosecond())
+#define digitalPinToInterrupt(p) (((p) < NUM_DIGITAL_PINS) ? (p) : -1)
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define bit(b) (1UL << (b))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef void (*voidFuncPtrArg)(void*);
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+void attachInterruptArg(uint8_t pin, voidFuncPtrArg handler, void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+void setup();
+void loop();
+
+#endif
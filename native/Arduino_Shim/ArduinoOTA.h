@@ -0,0 +1,20 @@
+/**
+ * Arduino Shim
+ * No updates arrive over the air on the host.
+ **/
+#ifndef ARDUINOOTA_SHIM_H
+#define ARDUINOOTA_SHIM_H
+
+#include "Arduino.h"
+
+class ArduinoOTAClass{
+    public:
+        void setHostname(const char*){}
+        void setPassword(const char*){}
+        void begin(){}
+        void handle(){}
+};
+
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif
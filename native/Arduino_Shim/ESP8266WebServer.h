@@ -0,0 +1,137 @@
+/**
+ * Arduino Shim
+ * Web server with no network behind it: handlers are kept by URI and method, and request()
+ * runs one the way a browser would have, recording the responses that are sent.
+ **/
+#ifndef ESP8266WEBSERVER_SHIM_H
+#define ESP8266WEBSERVER_SHIM_H
+
+#include "Arduino.h"
+#include "FS.h"
+
+#include <functional>
+#include <vector>
+
+enum HTTPMethod{ HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE,
+    HTTP_OPTIONS };
+enum HTTPUploadStatus{ UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END,
+    UPLOAD_FILE_ABORTED };
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define HTTP_UPLOAD_BUFLEN 2048
+
+typedef struct{
+    HTTPUploadStatus status;
+    String filename;
+    String name;
+    String type;
+    size_t totalSize;
+    size_t currentSize;
+    uint8_t buf[HTTP_UPLOAD_BUFLEN];
+} HTTPUpload;
+
+class ESP8266WebServer{
+    public:
+        typedef std::function<void(void)> THandlerFunction;
+
+        // A response, as the browser would have received it
+        struct Response{
+            int code;
+            String content_type;
+            String content;
+        };
+
+        ESP8266WebServer(int port = 80) : _port(port){}
+
+        void begin(){ _running = true; }
+        void handleClient(){}
+
+        void on(const String& uri, HTTPMethod method, THandlerFunction handler){
+            on(uri, method, handler, THandlerFunction());
+        }
+        void on(const String& uri, HTTPMethod method, THandlerFunction handler,
+            THandlerFunction upload_handler){
+            _handlers.push_back({uri, method, handler, upload_handler});
+        }
+        void onNotFound(THandlerFunction handler){ _not_found = handler; }
+
+        void send(int code, const char* content_type = NULL, const String& content = String()){
+            _responses.push_back({code, content_type ? content_type : "", content});
+        }
+        void send(int code, const String& content_type, const String& content){
+            send(code, content_type.c_str(), content);
+        }
+        void sendHeader(const String&, const String&, bool = false){}
+        void setContentLength(size_t){}
+        void sendContent(const String& content){ sendContent(content.c_str(), content.length()); }
+        void sendContent(const char* content){ sendContent(content, strlen(content)); }
+        void sendContent(const char* content, size_t size){
+            if(_responses.empty()) send(200);
+            _responses.back().content.concat(content, size);
+        }
+
+        template<typename T>
+        size_t streamFile(T& file, const String& content_type, HTTPMethod = HTTP_GET){
+            send(200, content_type, "");
+            uint8_t buffer[256];
+            size_t sent = 0;
+            while(file.available()){
+                int length = file.read(buffer, sizeof(buffer));
+                if(length <= 0) break;
+                sendContent((const char*)buffer, length);
+                sent += length;
+            }
+            return sent;
+        }
+
+        String arg(int index) const{
+            return index >= 0 && index < (int)_args.size() ? _args[index] : String();
+        }
+        int args() const{ return _args.size(); }
+        const String& uri() const{ return _uri; }
+        HTTPUpload& upload(){ return _upload; }
+
+        /**
+         * Run the handler for a request, as handleClient() would have
+         * @param method of the request
+         * @param uri of the request
+         * @param args form fields, in order
+         * @return true if a handler other than onNotFound() ran
+         **/
+        bool request(HTTPMethod method, const String& uri,
+            const std::vector<String>& args = std::vector<String>()){
+            _uri = uri;
+            _args = args;
+            for(auto& handler : _handlers){
+                if(handler.uri == uri && (handler.method == HTTP_ANY || handler.method == method)){
+                    handler.handler();
+                    return true;
+                }
+            }
+            if(_not_found) _not_found();
+            return false;
+        }
+
+        const std::vector<Response>& responses() const{ return _responses; }
+        void clear_responses(){ _responses.clear(); }
+        bool running() const{ return _running; }
+
+    private:
+        struct Handler{
+            String uri;
+            HTTPMethod method;
+            THandlerFunction handler;
+            THandlerFunction upload_handler;
+        };
+
+        int _port;
+        bool _running = false;
+        std::vector<Handler> _handlers;
+        THandlerFunction _not_found;
+        std::vector<Response> _responses;
+        std::vector<String> _args;
+        String _uri;
+        HTTPUpload _upload;
+};
+
+#endif
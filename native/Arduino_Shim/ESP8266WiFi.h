@@ -0,0 +1,51 @@
+/**
+ * Arduino Shim
+ * WiFi is never up on the host: the mode and access point are recorded so tests can check
+ * when the timer would have turned them on.
+ **/
+#ifndef ESP8266WIFI_SHIM_H
+#define ESP8266WIFI_SHIM_H
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+typedef enum WiFiMode{
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} WiFiMode_t;
+
+class ESP8266WiFiClass{
+    public:
+        void persistent(bool persistent){ _persistent = persistent; }
+        bool mode(WiFiMode_t mode){
+            _mode = mode;
+            return true;
+        }
+        WiFiMode_t getMode() const{ return _mode; }
+
+        bool softAPConfig(IPAddress local_ip, IPAddress gateway, IPAddress subnet){
+            _ap_ip = local_ip;
+            return true;
+        }
+        bool softAP(const String& ssid, const String& passphrase = String()){
+            _ap_ssid = ssid;
+            _ap_passphrase = passphrase;
+            return true;
+        }
+        IPAddress softAPIP() const{ return _ap_ip; }
+        const String& softAPSSID() const{ return _ap_ssid; }
+        const String& softAPPSK() const{ return _ap_passphrase; }
+
+    private:
+        bool _persistent = true;
+        WiFiMode_t _mode = WIFI_OFF;
+        IPAddress _ap_ip;
+        String _ap_ssid;
+        String _ap_passphrase;
+};
+
+extern ESP8266WiFiClass WiFi;
+
+#endif
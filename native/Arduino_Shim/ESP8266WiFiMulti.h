@@ -0,0 +1,23 @@
+/**
+ * Arduino Shim
+ * No networks to join on the host.
+ **/
+#ifndef ESP8266WIFIMULTI_SHIM_H
+#define ESP8266WIFIMULTI_SHIM_H
+
+#include "ESP8266WiFi.h"
+
+typedef enum{
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+class ESP8266WiFiMulti{
+    public:
+        bool addAP(const char*, const char* = NULL){ return true; }
+        wl_status_t run(){ return WL_DISCONNECTED; }
+};
+
+#endif
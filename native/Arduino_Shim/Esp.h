@@ -0,0 +1,28 @@
+/**
+ * Arduino Shim
+ * ESP class. The heap figures are fixed, restart() ends the program, and the RTC user memory
+ * and reset reason can be set up by tests (see Native.h) to act like a reset mid-match.
+ **/
+#ifndef ESP_SHIM_H
+#define ESP_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "user_interface.h"
+
+class EspClass{
+    public:
+        uint32_t getFreeHeap();
+        uint32_t getMaxFreeBlockSize();
+        uint8_t getHeapFragmentation();
+        uint8_t getCpuFreqMHz();
+        uint32_t getCycleCount();
+        struct rst_info* getResetInfoPtr();
+        bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size);
+        bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size);
+        [[noreturn]] void restart();
+};
+
+extern EspClass ESP;
+
+#endif
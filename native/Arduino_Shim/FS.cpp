@@ -0,0 +1,246 @@
+/**
+ * Arduino Shim
+ * File system API of the ESP8266 core, on top of an FSImpl.
+ **/
+#include "FS.h"
+#include "FSImpl.h"
+
+using namespace fs;
+
+/**
+ * @param mode fopen() style mode ("r", "w", "a", with an optional "+")
+ * @param om open mode to fill in
+ * @param am access mode to fill in
+ * @return false if the mode isn't valid
+ **/
+static bool sflags(const char* mode, OpenMode& om, AccessMode& am){
+    int read_write = mode[1] == '+' || (mode[1] == 'b' && mode[2] == '+');
+    switch(mode[0]){
+        case 'r':
+            am = read_write ? AM_RW : AM_READ;
+            om = OM_DEFAULT;
+            return true;
+        case 'w':
+            am = read_write ? AM_RW : AM_WRITE;
+            om = (OpenMode)(OM_CREATE | OM_TRUNCATE);
+            return true;
+        case 'a':
+            am = read_write ? AM_RW : AM_WRITE;
+            om = (OpenMode)(OM_CREATE | OM_APPEND);
+            return true;
+    }
+    return false;
+}
+
+size_t File::write(uint8_t c){
+    if(!_p) return 0;
+    return _p->write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buf, size_t size){
+    if(!_p) return 0;
+    return _p->write(buf, size);
+}
+
+int File::available(){
+    if(!_p) return 0;
+    return _p->size() - _p->position();
+}
+
+int File::read(){
+    if(!_p) return -1;
+    uint8_t result;
+    if(_p->read(&result, 1) != 1) return -1;
+    return result;
+}
+
+int File::read(uint8_t* buf, size_t size){
+    if(!_p) return -1;
+    return _p->read(buf, size);
+}
+
+int File::peek(){
+    if(!_p) return -1;
+    size_t position = _p->position();
+    int result = read();
+    _p->seek(position, SeekSet);
+    return result;
+}
+
+void File::flush(){
+    if(_p) _p->flush();
+}
+
+bool File::seek(uint32_t pos, SeekMode mode){
+    if(!_p) return false;
+    return _p->seek(pos, mode);
+}
+
+size_t File::position() const{
+    if(!_p) return 0;
+    return _p->position();
+}
+
+size_t File::size() const{
+    if(!_p) return 0;
+    return _p->size();
+}
+
+bool File::truncate(uint32_t size){
+    if(!_p) return false;
+    return _p->truncate(size);
+}
+
+void File::close(){
+    if(_p){
+        _p->close();
+        _p = nullptr;
+    }
+}
+
+File::operator bool() const{
+    return !!_p;
+}
+
+const char* File::name() const{
+    if(!_p) return nullptr;
+    return _p->name();
+}
+
+const char* File::fullName() const{
+    if(!_p) return nullptr;
+    return _p->fullName();
+}
+
+bool File::isFile() const{
+    if(!_p) return false;
+    return _p->isFile();
+}
+
+bool File::isDirectory() const{
+    if(!_p) return false;
+    return _p->isDirectory();
+}
+
+String File::readString(){
+    String out;
+    uint8_t buffer[256];
+    int length;
+    while((length = read(buffer, sizeof(buffer))) > 0) out.concat((const char*)buffer, length);
+    return out;
+}
+
+File Dir::openFile(const char* mode){
+    if(!_impl) return File();
+    OpenMode om;
+    AccessMode am;
+    if(!sflags(mode, om, am)) return File();
+    return File(_impl->openFile(om, am), _baseFS);
+}
+
+String Dir::fileName(){
+    if(!_impl) return String();
+    return _impl->fileName();
+}
+
+size_t Dir::fileSize(){
+    if(!_impl) return 0;
+    return _impl->fileSize();
+}
+
+bool Dir::isFile() const{
+    if(!_impl) return false;
+    return _impl->isFile();
+}
+
+bool Dir::isDirectory() const{
+    if(!_impl) return false;
+    return _impl->isDirectory();
+}
+
+bool Dir::next(){
+    if(!_impl) return false;
+    return _impl->next();
+}
+
+bool Dir::rewind(){
+    if(!_impl) return false;
+    return _impl->rewind();
+}
+
+bool FS::setConfig(const FSConfig& cfg){
+    if(!_impl) return false;
+    return _impl->setConfig(cfg);
+}
+
+bool FS::begin(){
+    if(!_impl) return false;
+    return _impl->begin();
+}
+
+void FS::end(){
+    if(_impl) _impl->end();
+}
+
+bool FS::format(){
+    if(!_impl) return false;
+    return _impl->format();
+}
+
+bool FS::info(FSInfo& info){
+    if(!_impl) return false;
+    return _impl->info(info);
+}
+
+bool FS::info64(FSInfo64& info){
+    if(!_impl) return false;
+    return _impl->info64(info);
+}
+
+File FS::open(const char* path, const char* mode){
+    if(!_impl) return File();
+    OpenMode om;
+    AccessMode am;
+    if(!sflags(mode, om, am)) return File();
+    return File(_impl->open(path, om, am), this);
+}
+
+bool FS::exists(const char* path){
+    if(!_impl) return false;
+    return _impl->exists(path);
+}
+
+Dir FS::openDir(const char* path){
+    if(!_impl) return Dir();
+    return Dir(_impl->openDir(path), this);
+}
+
+bool FS::remove(const char* path){
+    if(!_impl) return false;
+    return _impl->remove(path);
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo){
+    if(!_impl) return false;
+    return _impl->rename(pathFrom, pathTo);
+}
+
+bool FS::mkdir(const char* path){
+    if(!_impl) return false;
+    return _impl->mkdir(path);
+}
+
+bool FS::rmdir(const char* path){
+    if(!_impl) return false;
+    return _impl->rmdir(path);
+}
+
+bool FS::gc(){
+    if(!_impl) return false;
+    return _impl->gc();
+}
+
+bool FS::check(){
+    if(!_impl) return false;
+    return _impl->check();
+}
@@ -0,0 +1,157 @@
+/**
+ * Arduino Shim
+ * File system API of the ESP8266 core. SPIFFS and LittleFS are both kept in a temporary
+ * directory on the host, which starts empty and is removed when the program ends (see
+ * native_fs_load() in Native.h to copy files in).
+ **/
+#ifndef FS_SHIM_H
+#define FS_SHIM_H
+
+#include <memory>
+#include "Arduino.h"
+
+namespace fs{
+
+class File;
+class Dir;
+class FS;
+
+class FileImpl;
+typedef std::shared_ptr<FileImpl> FileImplPtr;
+class FSImpl;
+typedef std::shared_ptr<FSImpl> FSImplPtr;
+class DirImpl;
+typedef std::shared_ptr<DirImpl> DirImplPtr;
+
+enum SeekMode{
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+class File : public Stream{
+    public:
+        File(FileImplPtr p = FileImplPtr(), FS* baseFS = nullptr) : _p(p), _baseFS(baseFS){}
+
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t* buf, size_t size) override;
+        int available() override;
+        int read() override;
+        int peek() override;
+        void flush() override;
+        size_t readBytes(char* buffer, size_t length) override{
+            int result = read((uint8_t*)buffer, length);
+            return result < 0 ? 0 : result;
+        }
+        int read(uint8_t* buf, size_t size);
+        bool seek(uint32_t pos, SeekMode mode);
+        bool seek(uint32_t pos){ return seek(pos, SeekSet); }
+        size_t position() const;
+        size_t size() const;
+        bool truncate(uint32_t size);
+        void close();
+        operator bool() const;
+        const char* name() const;
+        const char* fullName() const;
+        bool isFile() const;
+        bool isDirectory() const;
+        String readString() override;
+
+        using Print::write;
+
+    protected:
+        FileImplPtr _p;
+        FS* _baseFS;
+};
+
+class Dir{
+    public:
+        Dir(DirImplPtr impl = DirImplPtr(), FS* baseFS = nullptr) : _impl(impl), _baseFS(baseFS){}
+
+        File openFile(const char* mode);
+        String fileName();
+        size_t fileSize();
+        bool isFile() const;
+        bool isDirectory() const;
+        bool next();
+        bool rewind();
+
+    protected:
+        DirImplPtr _impl;
+        FS* _baseFS;
+};
+
+struct FSInfo{
+    size_t totalBytes;
+    size_t usedBytes;
+    size_t blockSize;
+    size_t pageSize;
+    size_t maxOpenFiles;
+    size_t maxPathLength;
+};
+
+struct FSInfo64{
+    uint64_t totalBytes;
+    uint64_t usedBytes;
+    size_t blockSize;
+    size_t pageSize;
+    size_t maxOpenFiles;
+    size_t maxPathLength;
+};
+
+class FSConfig{
+    public:
+        FSConfig(uint32_t type = 0, bool autoFormat = true) : _type(type), _autoFormat(autoFormat){}
+        uint32_t _type;
+        bool _autoFormat;
+};
+
+class FS{
+    public:
+        FS(FSImplPtr impl) : _impl(impl){}
+
+        bool setConfig(const FSConfig& cfg);
+        bool begin();
+        void end();
+        bool format();
+        bool info(FSInfo& info);
+        bool info64(FSInfo64& info);
+
+        File open(const char* path, const char* mode);
+        File open(const String& path, const char* mode){ return open(path.c_str(), mode); }
+        bool exists(const char* path);
+        bool exists(const String& path){ return exists(path.c_str()); }
+        Dir openDir(const char* path);
+        Dir openDir(const String& path){ return openDir(path.c_str()); }
+        bool remove(const char* path);
+        bool remove(const String& path){ return remove(path.c_str()); }
+        bool rename(const char* pathFrom, const char* pathTo);
+        bool rename(const String& pathFrom, const String& pathTo){
+            return rename(pathFrom.c_str(), pathTo.c_str());
+        }
+        bool mkdir(const char* path);
+        bool mkdir(const String& path){ return mkdir(path.c_str()); }
+        bool rmdir(const char* path);
+        bool rmdir(const String& path){ return rmdir(path.c_str()); }
+        bool gc();
+        bool check();
+
+    protected:
+        FSImplPtr _impl;
+};
+
+}
+
+using fs::FS;
+using fs::File;
+using fs::Dir;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::FSInfo;
+using fs::FSConfig;
+
+extern fs::FS SPIFFS;
+
+#endif
@@ -0,0 +1,32 @@
+/**
+ * Arduino Shim
+ * Serial (UART0) prints to stdout and reads nothing. Serial1 (UART1) writes into the UART1 TX
+ * FIFO, like the hardware.
+ **/
+#include "HardwareSerial.h"
+#include "esp8266_peri.h"
+
+#include <stdio.h>
+
+HardwareSerial Serial(UART0);
+HardwareSerial Serial1(UART1);
+
+void HardwareSerial::begin(unsigned long baud, uint8_t config, SerialMode mode){
+    _baud = baud;
+    _config = config;
+    _mode = mode;
+}
+
+size_t HardwareSerial::write(uint8_t c){
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size){
+    if(_uart_nr == UART0) return fwrite(buffer, 1, size, stdout);
+    for(size_t i = 0; i < size; i++) USF(_uart_nr) = buffer[i];
+    return size;
+}
+
+void HardwareSerial::flush(){
+    if(_uart_nr == UART0) fflush(stdout);
+}
@@ -0,0 +1,49 @@
+/**
+ * Arduino Shim
+ * Serial (UART0) prints to stdout and reads nothing. Serial1 (UART1) writes into the UART1 TX
+ * FIFO, like the hardware.
+ **/
+#ifndef HARDWARESERIAL_SHIM_H
+#define HARDWARESERIAL_SHIM_H
+
+#include "Stream.h"
+
+#define SERIAL_5N1  0x10
+#define SERIAL_6N1  0x14
+#define SERIAL_7N1  0x18
+#define SERIAL_8N1  0x1c
+
+enum SerialMode{SERIAL_FULL = 0, SERIAL_RX_ONLY = 1, SERIAL_TX_ONLY = 2};
+
+class HardwareSerial : public Stream{
+    public:
+        HardwareSerial(int uart_nr) : _uart_nr(uart_nr){}
+
+        void begin(unsigned long baud){ begin(baud, SERIAL_8N1, SERIAL_FULL); }
+        void begin(unsigned long baud, uint8_t config){ begin(baud, config, SERIAL_FULL); }
+        void begin(unsigned long baud, uint8_t config, SerialMode mode);
+        void end(){}
+
+        unsigned long baudRate() const{ return _baud; }
+        uint8_t config() const{ return _config; }
+        SerialMode mode() const{ return _mode; }
+
+        int available() override{ return 0; }
+        int read() override{ return -1; }
+        int peek() override{ return -1; }
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t* buffer, size_t size) override;
+        void flush() override;
+        using Print::write;
+
+    private:
+        int _uart_nr;
+        unsigned long _baud = 0;
+        uint8_t _config = SERIAL_8N1;
+        SerialMode _mode = SERIAL_FULL;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+#endif
@@ -0,0 +1,365 @@
+/**
+ * Arduino Shim
+ * SPIFFS and LittleFS on the host: both are the same temporary directory, created when the
+ * file system is first mounted and removed when the program ends. Paths are the same as on
+ * the device ("/settings.txt"), and parent directories are made as files are created, like
+ * LittleFS does.
+ **/
+#include "FS.h"
+#include "FSImpl.h"
+#include "LittleFS.h"
+#include "Native.h"
+
+#include <filesystem>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace host_fs = std::filesystem;
+
+// Same size as the file system of the 4MB (3MB FS) flash layout
+#define HOST_FS_SIZE (3 * 1024 * 1024)
+
+static std::string fs_root;
+
+/**
+ * Remove the directory when the program ends
+ **/
+static void fs_cleanup(){
+    std::error_code error;
+    if(!fs_root.empty()) host_fs::remove_all(fs_root, error);
+}
+
+/**
+ * Create the directory the first time the file system is mounted
+ * @return true if it exists
+ **/
+static bool fs_create(){
+    if(!fs_root.empty()) return true;
+    std::string pattern = (host_fs::temp_directory_path() / "battlebricks_fs_XXXXXX").string();
+    std::vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+    if(mkdtemp(path.data()) == NULL) return false;
+    fs_root = path.data();
+    atexit(fs_cleanup);
+    return true;
+}
+
+/**
+ * @param path on the device
+ * @return path on the host
+ **/
+static std::string host_path(const char* path){
+    std::string out = fs_root;
+    if(path[0] != '/') out += '/';
+    return out + path;
+}
+
+class Host_File_Impl : public fs::FileImpl{
+    public:
+
+        Host_File_Impl(FILE* file, const String& path, fs::OpenMode open_mode,
+            fs::AccessMode access_mode) : _file(file), _path(path){
+            _read = access_mode & fs::AM_READ;
+            _write = access_mode & fs::AM_WRITE;
+            _append = open_mode & fs::OM_APPEND;
+            _name = strrchr(_path.c_str(), '/');
+            _name = _name ? _name + 1 : _path.c_str();
+        }
+
+        ~Host_File_Impl(){
+            close();
+        }
+
+        size_t write(const uint8_t* buf, size_t size) override{
+            if(_file == NULL || !_write) return 0;
+            // Writes after reads must reposition the stream first
+            fseek(_file, 0, _append ? SEEK_END : SEEK_CUR);
+            return fwrite(buf, 1, size, _file);
+        }
+
+        int read(uint8_t* buf, size_t size) override{
+            if(_file == NULL || !_read) return -1;
+            // Likewise for reads after writes
+            fseek(_file, 0, SEEK_CUR);
+            return fread(buf, 1, size, _file);
+        }
+
+        void flush() override{
+            if(_file != NULL) fflush(_file);
+        }
+
+        bool seek(uint32_t pos, fs::SeekMode mode) override{
+            if(_file == NULL) return false;
+            size_t length = size();
+            size_t from = mode == fs::SeekCur ? position() : mode == fs::SeekEnd ? length : 0;
+            if(mode == fs::SeekEnd){
+                if(pos > length) return false;
+                from = length - pos;
+                pos = 0;
+            }
+            if(from + pos > length) return false;
+            return fseek(_file, from + pos, SEEK_SET) == 0;
+        }
+
+        size_t position() const override{
+            if(_file == NULL) return 0;
+            long position = ftell(_file);
+            return position < 0 ? 0 : position;
+        }
+
+        size_t size() const override{
+            if(_file == NULL) return 0;
+            fflush(_file);
+            struct stat info;
+            if(fstat(fileno(_file), &info) != 0) return 0;
+            return info.st_size;
+        }
+
+        bool truncate(uint32_t size) override{
+            if(_file == NULL || !_write) return false;
+            fflush(_file);
+            return ftruncate(fileno(_file), size) == 0;
+        }
+
+        void close() override{
+            if(_file != NULL) fclose(_file);
+            _file = NULL;
+        }
+
+        const char* name() const override{
+            return _name;
+        }
+
+        const char* fullName() const override{
+            return _path.c_str();
+        }
+
+        bool isFile() const override{
+            return true;
+        }
+
+        bool isDirectory() const override{
+            return false;
+        }
+
+    private:
+        FILE* _file;
+        String _path;
+        const char* _name;
+        bool _read, _write, _append;
+};
+
+class Host_FS_Impl;
+
+class Host_Dir_Impl : public fs::DirImpl{
+    public:
+
+        Host_Dir_Impl(Host_FS_Impl& fs, const String& path, std::vector<host_fs::path> entries) :
+            _fs(fs), _path(path), _entries(entries){
+            if(!_path.endsWith("/")) _path += "/";
+        }
+
+        fs::FileImplPtr openFile(fs::OpenMode open_mode, fs::AccessMode access_mode) override;
+
+        const char* fileName() override{
+            _name = valid() ? _entries[_index].filename().string() : "";
+            return _name.c_str();
+        }
+
+        size_t fileSize() override{
+            std::error_code error;
+            if(!isFile()) return 0;
+            size_t size = host_fs::file_size(_entries[_index], error);
+            return error ? 0 : size;
+        }
+
+        bool isFile() const override{
+            std::error_code error;
+            return valid() && host_fs::is_regular_file(_entries[_index], error);
+        }
+
+        bool isDirectory() const override{
+            std::error_code error;
+            return valid() && host_fs::is_directory(_entries[_index], error);
+        }
+
+        bool next() override{
+            if(_index < (int)_entries.size()) _index++;
+            return valid();
+        }
+
+        bool rewind() override{
+            _index = -1;
+            return true;
+        }
+
+    private:
+        Host_FS_Impl& _fs;
+        String _path;
+        std::vector<host_fs::path> _entries;
+        std::string _name;
+        int _index = -1;
+
+        bool valid() const{
+            return _index >= 0 && _index < (int)_entries.size();
+        }
+};
+
+class Host_FS_Impl : public fs::FSImpl{
+    public:
+
+        bool setConfig(const fs::FSConfig&) override{
+            return true;
+        }
+
+        bool begin() override{
+            return fs_create();
+        }
+
+        void end() override{}
+
+        bool format() override{
+            if(!fs_create()) return false;
+            std::error_code error;
+            for(auto& entry : host_fs::directory_iterator(fs_root, error)){
+                host_fs::remove_all(entry.path(), error);
+            }
+            return !error;
+        }
+
+        bool info(fs::FSInfo& info) override{
+            fs::FSInfo64 info64;
+            if(!this->info64(info64)) return false;
+            info.totalBytes = info64.totalBytes;
+            info.usedBytes = info64.usedBytes;
+            info.blockSize = info64.blockSize;
+            info.pageSize = info64.pageSize;
+            info.maxOpenFiles = info64.maxOpenFiles;
+            info.maxPathLength = info64.maxPathLength;
+            return true;
+        }
+
+        bool info64(fs::FSInfo64& info) override{
+            if(!fs_create()) return false;
+            std::error_code error;
+            info.totalBytes = HOST_FS_SIZE;
+            info.usedBytes = 0;
+            for(auto& entry : host_fs::recursive_directory_iterator(fs_root, error)){
+                if(entry.is_regular_file(error)) info.usedBytes += entry.file_size(error);
+            }
+            info.blockSize = 8192;
+            info.pageSize = 256;
+            info.maxOpenFiles = 5;
+            info.maxPathLength = 32;
+            return true;
+        }
+
+        fs::FileImplPtr open(const char* path, fs::OpenMode open_mode,
+            fs::AccessMode access_mode) override{
+            if(!fs_create()) return fs::FileImplPtr();
+            std::string full_path = host_path(path);
+            std::error_code error;
+            if(host_fs::is_directory(full_path, error)) return fs::FileImplPtr();
+
+            bool exists = host_fs::exists(full_path, error);
+            if(!exists && !(open_mode & fs::OM_CREATE)) return fs::FileImplPtr();
+            if(open_mode & fs::OM_CREATE){
+                host_fs::create_directories(host_fs::path(full_path).parent_path(), error);
+            }
+
+            const char* mode = "r+b";
+            if(open_mode & fs::OM_TRUNCATE) mode = "w+b";
+            else if(!exists) mode = "w+b";
+            else if(!(access_mode & fs::AM_WRITE)) mode = "rb";
+            FILE* file = fopen(full_path.c_str(), mode);
+            if(file == NULL) return fs::FileImplPtr();
+            if(open_mode & fs::OM_APPEND) fseek(file, 0, SEEK_END);
+            return std::make_shared<Host_File_Impl>(file, path, open_mode, access_mode);
+        }
+
+        bool exists(const char* path) override{
+            if(!fs_create()) return false;
+            std::error_code error;
+            return host_fs::exists(host_path(path), error);
+        }
+
+        fs::DirImplPtr openDir(const char* path) override{
+            std::vector<host_fs::path> entries;
+            std::error_code error;
+            if(fs_create()){
+                for(auto& entry : host_fs::directory_iterator(host_path(path), error)){
+                    entries.push_back(entry.path());
+                }
+            }
+            return std::make_shared<Host_Dir_Impl>(*this, path, entries);
+        }
+
+        bool rename(const char* from, const char* to) override{
+            if(!fs_create()) return false;
+            std::error_code error;
+            if(!host_fs::is_regular_file(host_path(from), error)) return false;
+            host_fs::rename(host_path(from), host_path(to), error);
+            return !error;
+        }
+
+        bool remove(const char* path) override{
+            if(!fs_create()) return false;
+            std::error_code error;
+            if(!host_fs::is_regular_file(host_path(path), error)) return false;
+            return host_fs::remove(host_path(path), error);
+        }
+
+        bool mkdir(const char* path) override{
+            if(!fs_create()) return false;
+            std::error_code error;
+            host_fs::create_directories(host_path(path), error);
+            return !error;
+        }
+
+        bool rmdir(const char* path) override{
+            if(!fs_create()) return false;
+            std::error_code error;
+            return host_fs::remove(host_path(path), error);
+        }
+};
+
+fs::FileImplPtr Host_Dir_Impl::openFile(fs::OpenMode open_mode, fs::AccessMode access_mode){
+    if(!isFile()) return fs::FileImplPtr();
+    String path = _path + fileName();
+    return _fs.open(path.c_str(), open_mode, access_mode);
+}
+
+static fs::FSImplPtr host_fs_impl = std::make_shared<Host_FS_Impl>();
+
+fs::FS SPIFFS(host_fs_impl);
+fs::FS LittleFS(host_fs_impl);
+
+/**
+ * Copy files into the file system, like flashing a file system image (existing files with
+ * the same names are replaced)
+ * @param host_path directory whose contents go in the root, or a single file
+ * @return true if everything was copied
+ **/
+bool native_fs_load(const char* host_path){
+    if(!fs_create()) return false;
+    std::error_code error;
+    if(host_fs::is_directory(host_path, error)){
+        host_fs::copy(host_path, fs_root, host_fs::copy_options::recursive |
+            host_fs::copy_options::overwrite_existing, error);
+    }else{
+        host_fs::copy_file(host_path, host_fs::path(fs_root) / host_fs::path(host_path).filename(),
+            host_fs::copy_options::overwrite_existing, error);
+    }
+    return !error;
+}
+
+/**
+ * @return directory on the host that holds the file system
+ **/
+const char* native_fs_root(){
+    fs_create();
+    return fs_root.c_str();
+}
@@ -0,0 +1,26 @@
+/**
+ * Arduino Shim
+ * IPv4 address.
+ **/
+#ifndef IPADDRESS_SHIM_H
+#define IPADDRESS_SHIM_H
+
+#include <stdint.h>
+#include "WString.h"
+
+class IPAddress{
+    public:
+        IPAddress() : _address{0, 0, 0, 0}{}
+        IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _address{a, b, c, d}{}
+
+        uint8_t operator[](int index) const{ return _address[index & 3]; }
+        String toString() const{
+            return String(_address[0]) + "." + String(_address[1]) + "." + String(_address[2]) +
+                "." + String(_address[3]);
+        }
+
+    private:
+        uint8_t _address[4];
+};
+
+#endif
@@ -0,0 +1,12 @@
+/**
+ * Arduino Shim
+ * LittleFS, kept in the same temporary directory as SPIFFS (see FS.h).
+ **/
+#ifndef LITTLEFS_SHIM_H
+#define LITTLEFS_SHIM_H
+
+#include "FS.h"
+
+extern fs::FS LittleFS;
+
+#endif
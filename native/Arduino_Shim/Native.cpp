@@ -0,0 +1,330 @@
+/**
+ * Arduino Shim
+ * Time, pins, interrupts, the ESP class, the SDK calls, the UART registers and the WiFi and
+ * OTA objects, plus main() for the host program (tests bring their own).
+ **/
+#include "Arduino.h"
+#include "ArduinoOTA.h"
+#include "ESP8266WiFi.h"
+#include "Native.h"
+#include "coredecls.h"
+#include "core_esp8266_waveform.h"
+#include "gpio.h"
+#include "user_interface.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+
+static const auto native_start = std::chrono::steady_clock::now();
+
+/**
+ * @return time since the program started (us)
+ **/
+static uint64_t native_micros(){
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - native_start).count();
+}
+
+uint32_t millis(){
+    return native_micros() / 1000;
+}
+
+uint32_t micros(){
+    return native_micros();
+}
+
+void delay(uint32_t ms){
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us){
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield(){}
+
+/**
+ * PINS
+ **/
+static uint8_t pin_levels[NUM_DIGITAL_PINS];
+static uint8_t pin_modes[NUM_DIGITAL_PINS];
+static bool pin_levels_set = false;
+
+/**
+ * Inputs float high until a test drives them (buttons are to GND with pull-ups)
+ **/
+static void pins_begin(){
+    if(pin_levels_set) return;
+    pin_levels_set = true;
+    for(uint8_t i = 0; i < NUM_DIGITAL_PINS; i++) pin_levels[i] = HIGH;
+}
+
+void pinMode(uint8_t pin, uint8_t mode){
+    if(pin < NUM_DIGITAL_PINS) pin_modes[pin] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value){
+    pins_begin();
+    if(pin < NUM_DIGITAL_PINS) pin_levels[pin] = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin){
+    pins_begin();
+    return pin < NUM_DIGITAL_PINS ? pin_levels[pin] : LOW;
+}
+
+void analogWrite(uint8_t pin, int value){
+    digitalWrite(pin, value > 0);
+}
+
+void native_set_pin(uint8_t pin, uint8_t level){
+    digitalWrite(pin, level);
+}
+
+uint8_t native_get_pin(uint8_t pin){
+    return digitalRead(pin);
+}
+
+uint32_t native_gpio_in(){
+    pins_begin();
+    uint32_t levels = 0;
+    for(uint8_t i = 0; i < 16; i++){
+        if(pin_levels[i]) levels |= 1 << i;
+    }
+    return levels;
+}
+
+// Pin change interrupts are never raised, as pins only change when a test sets them
+void attachInterruptArg(uint8_t, voidFuncPtrArg, void*, int){}
+void detachInterrupt(uint8_t){}
+
+long random(long max){
+    return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max){
+    return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed){
+    srand(seed);
+}
+
+/**
+ * ESP CLASS
+ **/
+EspClass ESP;
+
+static struct rst_info reset_info = {REASON_DEFAULT_RST, 0, 0, 0, 0, 0, 0};
+static uint32_t rtc_user_memory[128];
+
+void native_set_reset_reason(uint32_t reason){
+    reset_info.reason = reason;
+}
+
+uint32_t EspClass::getFreeHeap(){
+    return 40000;
+}
+
+uint32_t EspClass::getMaxFreeBlockSize(){
+    return 30000;
+}
+
+uint8_t EspClass::getHeapFragmentation(){
+    return 0;
+}
+
+uint8_t EspClass::getCpuFreqMHz(){
+    return F_CPU / 1000000L;
+}
+
+uint32_t EspClass::getCycleCount(){
+    return native_micros() * (F_CPU / 1000000L);
+}
+
+struct rst_info* EspClass::getResetInfoPtr(){
+    return &reset_info;
+}
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size){
+    if(offset * 4 + size > sizeof(rtc_user_memory) || size % 4) return false;
+    memcpy(data, &rtc_user_memory[offset], size);
+    return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size){
+    if(offset * 4 + size > sizeof(rtc_user_memory) || size % 4) return false;
+    memcpy(&rtc_user_memory[offset], data, size);
+    return true;
+}
+
+void EspClass::restart(){
+    fflush(stdout);
+    exit(0);
+}
+
+/**
+ * SDK
+ **/
+uint32_t system_get_rtc_time(void){
+    return native_micros();
+}
+
+// RTC period in us, as a Q12 fixed point number
+uint32_t system_rtc_clock_cali_proc(void){
+    return 1 << 12;
+}
+
+bool wifi_set_opmode_current(uint8_t){ return true; }
+bool wifi_fpm_set_sleep_type(enum sleep_type){ return true; }
+void wifi_fpm_open(void){}
+void wifi_fpm_close(void){}
+void wifi_fpm_set_wakeup_cb(fpm_wakeup_cb){}
+int8_t wifi_fpm_do_sleep(uint32_t){ return 0; }
+void gpio_pin_wakeup_enable(uint32_t, GPIO_INT_TYPE){}
+void gpio_pin_wakeup_disable(void){}
+
+/**
+ * Same CRC as the core (polynomial 0x04c11db7, MSB first, no final XOR)
+ **/
+uint32_t crc32(const void* data, size_t length, uint32_t crc){
+    const uint8_t* bytes = (const uint8_t*)data;
+    while(length--){
+        uint8_t c = *bytes++;
+        for(uint32_t i = 0x80; i > 0; i >>= 1){
+            bool bit = crc & 0x80000000;
+            if(c & i) bit = !bit;
+            crc <<= 1;
+            if(bit) crc ^= 0x04c11db7;
+        }
+    }
+    return crc;
+}
+
+/**
+ * WAVEFORMS
+ **/
+static Native_Waveform waveforms[NUM_DIGITAL_PINS];
+
+int startWaveform(uint8_t pin, uint32_t timeHighUS, uint32_t timeLowUS, uint32_t runTimeUS,
+        int8_t, uint32_t, bool){
+    if(pin >= NUM_DIGITAL_PINS) return false;
+    Native_Waveform& waveform = waveforms[pin];
+    waveform.running = true;
+    waveform.high_time = timeHighUS;
+    waveform.low_time = timeLowUS;
+    waveform.run_time = runTimeUS;
+    waveform.starts++;
+    return true;
+}
+
+int stopWaveform(uint8_t pin){
+    if(pin >= NUM_DIGITAL_PINS) return false;
+    waveforms[pin].running = false;
+    return true;
+}
+
+void setTimer1Callback(uint32_t (*)()){}
+
+const Native_Waveform& native_waveform(uint8_t pin){
+    return waveforms[pin < NUM_DIGITAL_PINS ? pin : 0];
+}
+
+/**
+ * UART REGISTERS
+ **/
+Native_UART native_uart[2];
+static std::vector<uint8_t> uart_sent[2];
+static native_isr_function uart_isr = NULL;
+static void* uart_isr_arg = NULL;
+static bool uart_isr_enabled = false;
+static uint32_t uart_underruns[2];
+
+uint32_t native_uart_status(uint8_t uart){
+    size_t count = native_uart[uart].fifo.queued.size();
+    return (count > 0xFF ? 0xFF : count) << USTXC;
+}
+
+void native_uart_attach(native_isr_function isr, void* arg){
+    uart_isr = isr;
+    uart_isr_arg = arg;
+}
+
+void native_uart_enable(){
+    uart_isr_enabled = true;
+}
+
+/**
+ * Send bytes from a TX FIFO, raising the TX FIFO empty interrupt whenever the FIFO is below
+ * its threshold, like the hardware does as it shifts bytes out
+ * @param uart number
+ * @param bytes to send at most
+ * @param interrupts false if the interrupt can't run, so the FIFO isn't refilled
+ * @return bytes sent
+ **/
+static size_t uart_shift(uint8_t uart, size_t bytes, bool interrupts){
+    Native_UART& regs = native_uart[uart & 1];
+    std::vector<uint8_t>& queued = regs.fifo.queued;
+    size_t sent = 0;
+    while(sent < bytes && !queued.empty()){
+        uart_sent[uart & 1].push_back(queued.front());
+        queued.erase(queued.begin());
+        sent++;
+
+        uint32_t threshold = (regs.conf1 >> UCFET) & 0x7F;
+        if(queued.size() < threshold) regs.int_status |= 1 << UIFE;
+        if(interrupts && uart_isr_enabled && uart_isr != NULL && 
+            (regs.int_status & regs.int_enable)){
+            uart_isr(uart_isr_arg);
+            regs.int_status &= ~regs.int_clear;
+            regs.int_clear = 0;
+        }
+
+        // The interrupt is only left on while the sender has more, so the line went idle early
+        if(queued.empty() && (regs.int_enable & (1 << UIFE))) uart_underruns[uart & 1]++;
+    }
+    return sent;
+}
+
+size_t native_uart_drain(uint8_t uart, size_t bytes){
+    return uart_shift(uart, bytes, true);
+}
+
+/**
+ * Let time pass with interrupts disabled, as the NeoPixel bit-bang driver does: the UARTs 
+ * keep shifting out what is in their TX FIFOs at the rate they were begun with, but the 
+ * interrupt can't refill them
+ * @param time (us)
+ **/
+void native_interrupts_off(uint32_t time){
+    HardwareSerial* serials[2] = {&Serial, &Serial1};
+    for(uint8_t uart = 0; uart < 2; uart++){
+        uint32_t baud = serials[uart]->baudRate();
+        // Start bit, 5-8 data bits and a stop bit
+        uint8_t frame_bits = 7 + ((serials[uart]->config() >> 2) & 0x03);
+        if(baud > 0) uart_shift(uart, (uint64_t)time * baud / frame_bits / 1000000, false);
+    }
+}
+
+uint32_t native_uart_underruns(uint8_t uart){
+    return uart_underruns[uart & 1];
+}
+
+std::vector<uint8_t>& native_uart_sent(uint8_t uart){
+    return uart_sent[uart & 1];
+}
+
+ESP8266WiFiClass WiFi;
+ArduinoOTAClass ArduinoOTA;
+
+#ifndef PIO_UNIT_TESTING
+/**
+ * Run the sketch with the files that would be flashed
+ **/
+int main(){
+    native_fs_load("data");
+    setup();
+    while(true) loop();
+}
+#endif
@@ -0,0 +1,38 @@
+/**
+ * Arduino Shim
+ * Hooks for tests to drive the host build: set input pins, pick the reset reason, send what
+ * was queued in a UART (with or without its interrupt), see what the waveform generator was
+ * asked for, and copy files into the file system.
+ **/
+#ifndef NATIVE_SHIM_H
+#define NATIVE_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+struct Native_Waveform{
+    bool running;
+    uint32_t high_time;     // (us)
+    uint32_t low_time;      // (us)
+    uint32_t run_time;      // (us, 0 - until stopped)
+    uint32_t starts;        // Number of times it was started
+};
+
+void native_set_pin(uint8_t pin, uint8_t level);
+uint8_t native_get_pin(uint8_t pin);
+
+void native_set_reset_reason(uint32_t reason);
+
+size_t native_uart_drain(uint8_t uart, size_t bytes);
+std::vector<uint8_t>& native_uart_sent(uint8_t uart);
+// Times a TX FIFO ran empty while its sender still had bytes for it
+uint32_t native_uart_underruns(uint8_t uart);
+void native_interrupts_off(uint32_t time);
+
+const Native_Waveform& native_waveform(uint8_t pin);
+
+bool native_fs_load(const char* host_path);
+const char* native_fs_root();
+
+#endif
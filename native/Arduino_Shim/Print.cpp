@@ -0,0 +1,93 @@
+/**
+ * Arduino Shim
+ * Base class for everything that can be printed to (Serial, files, web responses).
+ **/
+#include "Print.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+size_t Print::write(const uint8_t* buffer, size_t size){
+    size_t written = 0;
+    while(size--){
+        if(!write(*buffer++)) break;
+        written++;
+    }
+    return written;
+}
+
+size_t Print::write(const char* str){
+    if(str == NULL) return 0;
+    return write((const uint8_t*)str, strlen(str));
+}
+
+size_t Print::write(const char* buffer, size_t size){
+    return write((const uint8_t*)buffer, size);
+}
+
+size_t Print::printf(const char* format, ...){
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+    if(length < 0){
+        va_end(args);
+        return 0;
+    }
+    std::vector<char> buffer(length + 1);
+    vsnprintf(buffer.data(), buffer.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)buffer.data(), length);
+}
+
+size_t Print::print(const String& str){
+    return write(str.c_str(), str.length());
+}
+
+size_t Print::print(const char* str){
+    return write(str);
+}
+
+size_t Print::print(char c){
+    return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char value, int base){
+    return print(String(value, base));
+}
+
+size_t Print::print(int value, int base){
+    return print(String(value, base));
+}
+
+size_t Print::print(unsigned int value, int base){
+    return print(String(value, base));
+}
+
+size_t Print::print(long value, int base){
+    return print(String(value, base));
+}
+
+size_t Print::print(unsigned long value, int base){
+    return print(String(value, base));
+}
+
+size_t Print::print(long long value, int base){
+    return print(String(value, base));
+}
+
+size_t Print::print(unsigned long long value, int base){
+    return print(String(value, base));
+}
+
+size_t Print::print(double value, int digits){
+    return print(String(value, digits));
+}
+
+size_t Print::println(){
+    return write("\r\n");
+}
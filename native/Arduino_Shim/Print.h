@@ -0,0 +1,55 @@
+/**
+ * Arduino Shim
+ * Base class for everything that can be printed to (Serial, files, web responses).
+ **/
+#ifndef PRINT_SHIM_H
+#define PRINT_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print{
+    public:
+        virtual ~Print(){}
+
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t* buffer, size_t size);
+        size_t write(const char* str);
+        size_t write(const char* buffer, size_t size);
+        virtual int availableForWrite(){ return 0; }
+        virtual void flush(){}
+
+        size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+        size_t print(const String& str);
+        size_t print(const char* str);
+        size_t print(char c);
+        size_t print(unsigned char value, int base = DEC);
+        size_t print(int value, int base = DEC);
+        size_t print(unsigned int value, int base = DEC);
+        size_t print(long value, int base = DEC);
+        size_t print(unsigned long value, int base = DEC);
+        size_t print(long long value, int base = DEC);
+        size_t print(unsigned long long value, int base = DEC);
+        size_t print(double value, int digits = 2);
+
+        size_t println();
+        template<typename T>
+        size_t println(const T& value){
+            size_t length = print(value);
+            return length + println();
+        }
+        template<typename T>
+        size_t println(const T& value, int format){
+            size_t length = print(value, format);
+            return length + println();
+        }
+};
+
+#endif
@@ -0,0 +1,31 @@
+/**
+ * Arduino Shim
+ * Base class for everything that can be read from (Serial, files). Nothing on the host
+ * arrives late, so reads don't wait for the timeout.
+ **/
+#include "Stream.h"
+
+size_t Stream::readBytes(char* buffer, size_t length){
+    size_t count = 0;
+    while(count < length){
+        int c = read();
+        if(c < 0) break;
+        *buffer++ = (char)c;
+        count++;
+    }
+    return count;
+}
+
+String Stream::readString(){
+    String out;
+    int c;
+    while((c = read()) >= 0) out += (char)c;
+    return out;
+}
+
+String Stream::readStringUntil(char terminator){
+    String out;
+    int c;
+    while((c = read()) >= 0 && c != terminator) out += (char)c;
+    return out;
+}
@@ -0,0 +1,30 @@
+/**
+ * Arduino Shim
+ * Base class for everything that can be read from (Serial, files).
+ **/
+#ifndef STREAM_SHIM_H
+#define STREAM_SHIM_H
+
+#include "Print.h"
+
+class Stream : public Print{
+    public:
+        virtual int available() = 0;
+        virtual int read() = 0;
+        virtual int peek() = 0;
+
+        void setTimeout(unsigned long timeout){ _timeout = timeout; }
+        unsigned long getTimeout() const{ return _timeout; }
+
+        virtual size_t readBytes(char* buffer, size_t length);
+        size_t readBytes(uint8_t* buffer, size_t length){
+            return readBytes((char*)buffer, length);
+        }
+        virtual String readString();
+        String readStringUntil(char terminator);
+
+    protected:
+        unsigned long _timeout = 1000;
+};
+
+#endif
@@ -0,0 +1,287 @@
+/**
+ * Arduino Shim
+ * Arduino String, kept in a std::string.
+ **/
+#include "WString.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/**
+ * @param value to convert
+ * @param base 2 to 36
+ * @param negative put a minus sign in front
+ * @return digits of value
+ **/
+static std::string format_unsigned(unsigned long long value, unsigned char base, bool negative){
+    if(base < 2 || base > 36) base = 10;
+    char digits[66];
+    char* p = &digits[sizeof(digits) - 1];
+    *p = '\0';
+    do{
+        unsigned char digit = value % base;
+        *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    }while(value);
+    if(negative) *--p = '-';
+    return p;
+}
+
+/**
+ * @param value to convert
+ * @param base 2 to 36 (negative numbers only get a sign in base 10, like ltoa())
+ * @return digits of value
+ **/
+static std::string format_signed(long long value, unsigned char base){
+    if(value < 0 && base == 10) return format_unsigned(-(unsigned long long)value, base, true);
+    return format_unsigned((unsigned long long)value, base, false);
+}
+
+/**
+ * @param value to convert
+ * @param decimal_places after the point
+ * @return value with a fixed number of decimals
+ **/
+static std::string format_float(double value, unsigned char decimal_places){
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimal_places, value);
+    return buffer;
+}
+
+String::String(unsigned char value, unsigned char base) :
+    _buffer(format_unsigned(value, base, false)){}
+String::String(int value, unsigned char base) : _buffer(format_signed(value, base)){}
+String::String(unsigned int value, unsigned char base) :
+    _buffer(format_unsigned(value, base, false)){}
+String::String(long value, unsigned char base) : _buffer(format_signed(value, base)){}
+String::String(unsigned long value, unsigned char base) :
+    _buffer(format_unsigned(value, base, false)){}
+String::String(long long value, unsigned char base) : _buffer(format_signed(value, base)){}
+String::String(unsigned long long value, unsigned char base) :
+    _buffer(format_unsigned(value, base, false)){}
+String::String(float value, unsigned char decimal_places) :
+    _buffer(format_float(value, decimal_places)){}
+String::String(double value, unsigned char decimal_places) :
+    _buffer(format_float(value, decimal_places)){}
+
+String& String::operator=(const char* cstr){
+    _buffer = cstr ? cstr : "";
+    return *this;
+}
+
+bool String::reserve(unsigned int size){
+    _buffer.reserve(size);
+    return true;
+}
+
+bool String::concat(const String& str){
+    _buffer += str._buffer;
+    return true;
+}
+
+bool String::concat(const char* cstr){
+    if(cstr == NULL) return false;
+    _buffer += cstr;
+    return true;
+}
+
+bool String::concat(const char* cstr, unsigned int length){
+    if(cstr == NULL) return false;
+    _buffer.append(cstr, length);
+    return true;
+}
+
+bool String::concat(char c){
+    _buffer += c;
+    return true;
+}
+
+bool String::concat(unsigned char value){ return concat(String(value)); }
+bool String::concat(int value){ return concat(String(value)); }
+bool String::concat(unsigned int value){ return concat(String(value)); }
+bool String::concat(long value){ return concat(String(value)); }
+bool String::concat(unsigned long value){ return concat(String(value)); }
+bool String::concat(long long value){ return concat(String(value)); }
+bool String::concat(unsigned long long value){ return concat(String(value)); }
+bool String::concat(float value){ return concat(String(value)); }
+bool String::concat(double value){ return concat(String(value)); }
+
+int String::compareTo(const String& str) const{
+    return strcmp(c_str(), str.c_str());
+}
+
+bool String::equals(const String& str) const{
+    return _buffer == str._buffer;
+}
+
+bool String::equals(const char* cstr) const{
+    return strcmp(c_str(), cstr ? cstr : "") == 0;
+}
+
+bool String::equalsIgnoreCase(const String& str) const{
+    return length() == str.length() && strcasecmp(c_str(), str.c_str()) == 0;
+}
+
+bool String::startsWith(const String& prefix) const{
+    return startsWith(prefix, 0);
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const{
+    if(offset > length() || prefix.length() > length() - offset) return false;
+    return _buffer.compare(offset, prefix.length(), prefix._buffer) == 0;
+}
+
+bool String::endsWith(const String& suffix) const{
+    if(suffix.length() > length()) return false;
+    return _buffer.compare(length() - suffix.length(), suffix.length(), suffix._buffer) == 0;
+}
+
+char String::charAt(unsigned int index) const{
+    return (*this)[index];
+}
+
+void String::setCharAt(unsigned int index, char c){
+    if(index < length()) _buffer[index] = c;
+}
+
+char String::operator[](unsigned int index) const{
+    return index < length() ? _buffer[index] : '\0';
+}
+
+char& String::operator[](unsigned int index){
+    static char dummy;
+    if(index >= length()){
+        dummy = '\0';
+        return dummy;
+    }
+    return _buffer[index];
+}
+
+int String::indexOf(char c, unsigned int from) const{
+    if(from >= length()) return -1;
+    size_t found = _buffer.find(c, from);
+    return found == std::string::npos ? -1 : (int)found;
+}
+
+int String::indexOf(const String& str, unsigned int from) const{
+    if(from >= length()) return -1;
+    size_t found = _buffer.find(str._buffer, from);
+    return found == std::string::npos ? -1 : (int)found;
+}
+
+int String::lastIndexOf(char c) const{
+    size_t found = _buffer.rfind(c);
+    return found == std::string::npos ? -1 : (int)found;
+}
+
+int String::lastIndexOf(const String& str) const{
+    if(str.length() > length()) return -1;
+    size_t found = _buffer.rfind(str._buffer);
+    return found == std::string::npos ? -1 : (int)found;
+}
+
+String String::substring(unsigned int left) const{
+    return substring(left, length());
+}
+
+String String::substring(unsigned int left, unsigned int right) const{
+    if(left > right){
+        unsigned int swap = left;
+        left = right;
+        right = swap;
+    }
+    String out;
+    if(left >= length()) return out;
+    if(right > length()) right = length();
+    out._buffer = _buffer.substr(left, right - left);
+    return out;
+}
+
+void String::replace(char find, char replace){
+    for(char& c : _buffer){
+        if(c == find) c = replace;
+    }
+}
+
+void String::replace(const String& find, const String& replace){
+    if(find.length() == 0) return;
+    size_t at = 0;
+    while((at = _buffer.find(find._buffer, at)) != std::string::npos){
+        _buffer.replace(at, find.length(), replace._buffer);
+        at += replace.length();
+    }
+}
+
+void String::remove(unsigned int index){
+    remove(index, (unsigned int)-1);
+}
+
+void String::remove(unsigned int index, unsigned int count){
+    if(index >= length()) return;
+    _buffer.erase(index, count);
+}
+
+void String::toLowerCase(){
+    for(char& c : _buffer) c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase(){
+    for(char& c : _buffer) c = toupper((unsigned char)c);
+}
+
+void String::trim(){
+    size_t first = _buffer.find_first_not_of(" \t\r\n\f\v");
+    if(first == std::string::npos){
+        _buffer.clear();
+        return;
+    }
+    size_t last = _buffer.find_last_not_of(" \t\r\n\f\v");
+    _buffer = _buffer.substr(first, last - first + 1);
+}
+
+long String::toInt() const{
+    return atol(c_str());
+}
+
+float String::toFloat() const{
+    return atof(c_str());
+}
+
+double String::toDouble() const{
+    return atof(c_str());
+}
+
+bool operator==(const char* lhs, const String& rhs){
+    return rhs.equals(lhs);
+}
+
+bool operator!=(const char* lhs, const String& rhs){
+    return !rhs.equals(lhs);
+}
+
+String operator+(const String& lhs, const String& rhs){
+    String sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+String operator+(const String& lhs, const char* rhs){
+    String sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+String operator+(const char* lhs, const String& rhs){
+    String sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+String operator+(const String& lhs, char rhs){
+    String sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
@@ -0,0 +1,130 @@
+/**
+ * Arduino Shim
+ * Arduino String, kept in a std::string. Numbers are only converted by the explicit
+ * constructors and concat(), as in the core.
+ **/
+#ifndef WSTRING_SHIM_H
+#define WSTRING_SHIM_H
+
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+
+class String{
+    public:
+        String(){}
+        String(const char* cstr) : _buffer(cstr ? cstr : ""){}
+        String(const String& str) = default;
+        String(String&& str) = default;
+        explicit String(char c) : _buffer(1, c){}
+        explicit String(unsigned char value, unsigned char base = 10);
+        explicit String(int value, unsigned char base = 10);
+        explicit String(unsigned int value, unsigned char base = 10);
+        explicit String(long value, unsigned char base = 10);
+        explicit String(unsigned long value, unsigned char base = 10);
+        explicit String(long long value, unsigned char base = 10);
+        explicit String(unsigned long long value, unsigned char base = 10);
+        explicit String(float value, unsigned char decimal_places = 2);
+        explicit String(double value, unsigned char decimal_places = 2);
+
+        String& operator=(const String& rhs) = default;
+        String& operator=(String&& rhs) = default;
+        String& operator=(const char* cstr);
+
+        bool reserve(unsigned int size);
+        unsigned int length() const{ return _buffer.length(); }
+        bool isEmpty() const{ return _buffer.empty(); }
+        const char* c_str() const{ return _buffer.c_str(); }
+        char* begin(){ return &_buffer[0]; }
+        char* end(){ return &_buffer[0] + _buffer.length(); }
+        const char* begin() const{ return c_str(); }
+        const char* end() const{ return c_str() + length(); }
+
+        bool concat(const String& str);
+        bool concat(const char* cstr);
+        bool concat(const char* cstr, unsigned int length);
+        bool concat(char c);
+        bool concat(unsigned char value);
+        bool concat(int value);
+        bool concat(unsigned int value);
+        bool concat(long value);
+        bool concat(unsigned long value);
+        bool concat(long long value);
+        bool concat(unsigned long long value);
+        bool concat(float value);
+        bool concat(double value);
+
+        template<typename T>
+        String& operator+=(const T& rhs){
+            concat(rhs);
+            return *this;
+        }
+
+        int compareTo(const String& str) const;
+        bool equals(const String& str) const;
+        bool equals(const char* cstr) const;
+        bool equalsIgnoreCase(const String& str) const;
+        bool startsWith(const String& prefix) const;
+        bool startsWith(const String& prefix, unsigned int offset) const;
+        bool endsWith(const String& suffix) const;
+
+        bool operator==(const String& rhs) const{ return equals(rhs); }
+        bool operator==(const char* cstr) const{ return equals(cstr); }
+        bool operator!=(const String& rhs) const{ return !equals(rhs); }
+        bool operator!=(const char* cstr) const{ return !equals(cstr); }
+        bool operator<(const String& rhs) const{ return compareTo(rhs) < 0; }
+        bool operator>(const String& rhs) const{ return compareTo(rhs) > 0; }
+        bool operator<=(const String& rhs) const{ return compareTo(rhs) <= 0; }
+        bool operator>=(const String& rhs) const{ return compareTo(rhs) >= 0; }
+
+        char charAt(unsigned int index) const;
+        void setCharAt(unsigned int index, char c);
+        char operator[](unsigned int index) const;
+        char& operator[](unsigned int index);
+
+        int indexOf(char c, unsigned int from = 0) const;
+        int indexOf(const String& str, unsigned int from = 0) const;
+        int lastIndexOf(char c) const;
+        int lastIndexOf(const String& str) const;
+        String substring(unsigned int left) const;
+        String substring(unsigned int left, unsigned int right) const;
+
+        void replace(char find, char replace);
+        void replace(const String& find, const String& replace);
+        void remove(unsigned int index);
+        void remove(unsigned int index, unsigned int count);
+        void toLowerCase();
+        void toUpperCase();
+        void trim();
+
+        long toInt() const;
+        float toFloat() const;
+        double toDouble() const;
+
+    private:
+        std::string _buffer;
+};
+
+// Only here so libraries that adapt to Arduino strings (ArduinoJson) find the type
+class StringSumHelper : public String{
+    public:
+        using String::String;
+        StringSumHelper(const String& str) : String(str){}
+};
+
+bool operator==(const char* lhs, const String& rhs);
+bool operator!=(const char* lhs, const String& rhs);
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+String operator+(const String& lhs, char rhs);
+
+template<typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+String operator+(const String& lhs, T rhs){
+    String sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+#endif
@@ -0,0 +1,16 @@
+/**
+ * Arduino Shim
+ * Timer1 waveform generator. Waveforms aren't generated, only recorded per pin (see Native.h),
+ * and the timer1 callback is kept but never called.
+ **/
+#ifndef CORE_ESP8266_WAVEFORM_SHIM_H
+#define CORE_ESP8266_WAVEFORM_SHIM_H
+
+#include <stdint.h>
+
+int startWaveform(uint8_t pin, uint32_t timeHighUS, uint32_t timeLowUS, uint32_t runTimeUS = 0,
+    int8_t alignPhase = -1, uint32_t phaseOffsetUS = 0, bool autoPwm = false);
+int stopWaveform(uint8_t pin);
+void setTimer1Callback(uint32_t (*fn)());
+
+#endif
@@ -0,0 +1,13 @@
+/**
+ * Arduino Shim
+ * Core helpers.
+ **/
+#ifndef COREDECLS_SHIM_H
+#define COREDECLS_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+uint32_t crc32(const void* data, size_t length, uint32_t crc = 0xffffffff);
+
+#endif
@@ -0,0 +1,71 @@
+/**
+ * Arduino Shim
+ * GPIO and UART registers. The GPIO input register is built from the pin array, and the UART
+ * registers are plain variables, except the TX FIFO which queues what is written to it until
+ * native_uart_drain() sends it (see Native.h).
+ **/
+#ifndef ESP8266_PERI_SHIM_H
+#define ESP8266_PERI_SHIM_H
+
+#include <stdint.h>
+#include <vector>
+
+uint32_t native_gpio_in();
+
+#define GPI         native_gpio_in()
+#define GPIP(p)     ((GPI >> (p)) & 1)
+
+#define UART0   0
+#define UART1   1
+
+// TX FIFO: every value written to it is queued as a byte
+class Native_UART_FIFO{
+    public:
+        std::vector<uint8_t> queued;
+
+        Native_UART_FIFO& operator=(uint32_t value){
+            queued.push_back(value & 0xFF);
+            return *this;
+        }
+};
+
+struct Native_UART{
+    uint32_t int_status = 0;
+    uint32_t int_enable = 0;
+    uint32_t int_clear = 0;
+    uint32_t conf0 = 0;
+    uint32_t conf1 = 0;
+    Native_UART_FIFO fifo;
+};
+
+extern Native_UART native_uart[2];
+uint32_t native_uart_status(uint8_t uart);
+
+#define USF(u)  (native_uart[(u) & 1].fifo)
+#define USIS(u) (native_uart[(u) & 1].int_status)
+#define USIE(u) (native_uart[(u) & 1].int_enable)
+#define USIC(u) (native_uart[(u) & 1].int_clear)
+#define USS(u)  (native_uart_status((u) & 1))
+#define USC0(u) (native_uart[(u) & 1].conf0)
+#define USC1(u) (native_uart[(u) & 1].conf1)
+
+// UART interrupt bits
+#define UIFE    1   // TX FIFO empty (below the threshold)
+#define UIFF    0   // RX FIFO full
+// UART status bits
+#define USTXC   16  // TX FIFO count (8 bits)
+#define USRXC   0   // RX FIFO count (8 bits)
+// UART CONF0 bits
+#define UCTXI   22  // Invert TX
+// UART CONF1 bits
+#define UCFET   8   // TX FIFO empty threshold (7 bits)
+#define UCFFT   0   // RX FIFO full threshold (7 bits)
+
+typedef void (*native_isr_function)(void*);
+void native_uart_attach(native_isr_function isr, void* arg);
+void native_uart_enable();
+
+#define ETS_UART_INTR_ATTACH(func, arg) native_uart_attach((native_isr_function)(func), (arg))
+#define ETS_UART_INTR_ENABLE()          native_uart_enable()
+
+#endif
@@ -0,0 +1,24 @@
+/**
+ * Arduino Shim
+ * Flash and RAM share one address space on the host, so PROGMEM data is read directly.
+ **/
+#ifndef PGMSPACE_SHIM_H
+#define PGMSPACE_SHIM_H
+
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr)     (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)     (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr)    (*(const uint32_t*)(addr))
+#define pgm_read_float(addr)    (*(const float*)(addr))
+#define pgm_read_ptr(addr)      (*(void* const*)(addr))
+
+#define memcpy_P    memcpy
+#define strlen_P    strlen
+#define strcmp_P    strcmp
+#define strncmp_P   strncmp
+
+#endif
@@ -0,0 +1,62 @@
+/**
+ * Arduino Shim
+ * The parts of the ESP8266 SDK the timer uses. Light sleep returns straight away, and the RTC
+ * counts the host's microseconds.
+ **/
+#ifndef USER_INTERFACE_SHIM_H
+#define USER_INTERFACE_SHIM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum rst_reason{
+    REASON_DEFAULT_RST = 0,
+    REASON_WDT_RST = 1,
+    REASON_EXCEPTION_RST = 2,
+    REASON_SOFT_WDT_RST = 3,
+    REASON_SOFT_RESTART = 4,
+    REASON_DEEP_SLEEP_AWAKE = 5,
+    REASON_EXT_SYS_RST = 6
+};
+
+struct rst_info{
+    uint32_t reason;
+    uint32_t exccause;
+    uint32_t epc1;
+    uint32_t epc2;
+    uint32_t epc3;
+    uint32_t excvaddr;
+    uint32_t depc;
+};
+
+#define NULL_MODE       0x00
+#define STATION_MODE    0x01
+#define SOFTAP_MODE     0x02
+#define STATIONAP_MODE  0x03
+
+enum sleep_type{
+    NONE_SLEEP_T = 0,
+    LIGHT_SLEEP_T,
+    MODEM_SLEEP_T
+};
+
+typedef void (*fpm_wakeup_cb)(void);
+
+uint32_t system_get_rtc_time(void);
+uint32_t system_rtc_clock_cali_proc(void);
+
+bool wifi_set_opmode_current(uint8_t opmode);
+bool wifi_fpm_set_sleep_type(enum sleep_type type);
+void wifi_fpm_open(void);
+void wifi_fpm_close(void);
+void wifi_fpm_set_wakeup_cb(fpm_wakeup_cb cb);
+int8_t wifi_fpm_do_sleep(uint32_t sleep_time_in_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -24,18 +24,22 @@
 ESP8266WiFiMulti wifimulti;
 Web_Interface webinterface;
 
-// Interrupts
-Soft_ISR state_isr;
-Soft_ISR buzzer_isr;
+bool wifi_on = false;
+
+// Timer sequence
+Soft_Timer state_timer;
 
 // In-game settings
 Persistent_Storage ingame_settings("pref");
 
 // Buttons
+const uint8_t button_pins[] = {PIN_BTN_BLACK, PIN_BTN_BLUE, PIN_BTN_RED, PIN_BTN_GREEN};
 Button btn_black(PIN_BTN_BLACK, true);
 Button btn_blue(PIN_BTN_BLUE, true);
 Button btn_red(PIN_BTN_RED, true);
 Button btn_green(PIN_BTN_GREEN, true);
+Input_Scanner scanner;
+Gesture_Engine gestures(scanner);
 
 // LED Matrix Displays
 Graphics graphics;
@@ -43,6 +47,13 @@ Graphics graphics;
 // Buzzer
 Buzzer buzzer(PIN_BUZZER, true);
 
+#ifdef PROFILE
+const char* const profile_stage_names[PROF_STAGES] = {
+    "scheduler", "input", "gfx_text", "gfx_bars", 
+    "gfx_compose", "gfx_strip", "gfx_show", "web", "loop"
+};
+#endif
+
 
 /**
  * Format Time
@@ -50,7 +61,7 @@ Buzzer buzzer(PIN_BUZZER, true);
  * @param colon display
  * @return time formatted for digital clock
  **/
-String format_time(uint8_t time, bool colon){
+String format_time(uint16_t time, bool colon){
     String minute = String(time / 60);
     String second = String(time % 60);
     if(second.length() == 1) second = "0" + second;
@@ -58,18 +69,53 @@ String format_time(uint8_t time, bool colon){
     return minute + " " + second;
 }
 
+/**
+ * Record a match event in the journal
+ * @param type of event
+ * @param player whose button or setting it was
+ **/
+void log_event(Journal_Type type, Journal_Player player = JOURNAL_NONE){
+    journal_record(type, player, state, match_clock.remaining(), clock_millis());
+}
+
+/**
+ * Record a button press in the journal, at the time of its first edge rather than when it 
+ * was debounced and handled
+ * @param button pressed
+ * @param player the button belongs to
+ **/
+void log_press(Button& button, Journal_Player player){
+    uint32_t age = (clock_micros() - button.get_press_time()) / 1000;
+    journal_record(JOURNAL_PRESS, player, state, match_clock.remaining(), clock_millis() - age);
+}
+
+/**
+ * Save the match state to RTC memory, so a reset mid-match can resume it
+ **/
+void checkpoint(){
+    Snapshot snapshot;
+    snapshot.remaining = match_clock.remaining();
+    snapshot.total_time = total_time;
+    snapshot.state = state;
+    snapshot.mode = mode;
+    snapshot.ready = red_ready | blue_ready << 1 | green_ready << 2;
+    snapshot.brightness = graphics.get_brightness();
+    snapshot.color_timer = config.color_timer;
+    snapshot_save(snapshot);
+}
+
 /**
  * TIMER SEQUENCE
  *  V V V V V V V
  **/
 void ready();
 void standby();
-void countdown_a();
+void countdown();
 
 // Reset state
 void reset(){
     state = STANDBY;
-    state_isr.remove();
+    state_timer.remove();
     red_ready = false;
     blue_ready = false;
     green_ready = false;
@@ -77,26 +123,30 @@ void reset(){
     graphics.set_blue_ready(false);
     graphics.set_green_ready(false);
     standby();
+    log_event(JOURNAL_RESET);
+    checkpoint();
 }
 
 // Display 0:00 post-game-over
 void post_game_over(){
-    if(auto_reset) {
+    if(config.auto_reset) {
         reset();
     } else{
-        graphics.text_static("0:00", color_timer);
+        graphics.text_static("0:00", config.color_timer);
     }
 }
 
 // Display game over message
 void game_over(){
     state = GAME_OVER;
-    if(game_over_time > 0) {
-        buzzer.beep(game_over_time*1000);
-        graphics.text_dynamic(msg_game_over,"Red");
-        state_isr.set_timer(post_game_over,game_over_time*1000);
+    log_event(JOURNAL_GAME_OVER);
+    checkpoint();
+    if(config.game_over_time > 0) {
+        buzzer.beep(config.game_over_time*1000);
+        graphics.text_dynamic(config.msg_game_over,COLOR_RED);
+        state_timer.set_timer(post_game_over,config.game_over_time*1000);
     }else{
-        buzzer.beep(2000);
+        buzzer.play(sounds[SOUND_GAME_OVER]);
         post_game_over();
     }
 }
@@ -104,72 +154,78 @@ void game_over(){
 // Display paused message
 void pause(){
     state = PAUSED;
-    state_isr.remove();
-    time_remaining = time_remaining - go_time + 1;
-    if(time_remaining < 0) time_remaining = 0;
-    graphics.text_dynamic("PAUSED", "Yellow");
+    state_timer.remove();
+    match_clock.pause();
+    graphics.text_dynamic("PAUSED", COLOR_YELLOW);
+    log_event(JOURNAL_PAUSE);
+    checkpoint();
 }
 
-// Display time remaining without colon and decrement time by 1 second
-void countdown_b(){
-    graphics.text_static(format_time(time_remaining, false), color_timer);
-    if(time_remaining <= 1) {
-        state_isr.set_timer(game_over,500);
-    } else {
-        state_isr.set_timer(countdown_a,500);
+// Display time remaining until the next half second, or end the game when time is up
+void countdown(){
+    if(match_clock.remaining() == 0){
+        game_over();
+        return;
     }
-    
-}
-
-// Display time remaining with colon
-void countdown_a(){
-    time_remaining--;
-    graphics.text_static(format_time(time_remaining, true), color_timer);
-    state_isr.set_timer(countdown_b,500);
+    graphics.text_static(format_time(match_clock.seconds(), match_clock.colon()), config.color_timer);
+    // Save the time once a second, as each second starts
+    if(match_clock.colon()) checkpoint();
+    state_timer.set_timer_at(countdown, match_clock.next_tick());
 }
 
 // Display go message
 void pre_countdown_go(){
     state = COUNTDOWN;
-    if(go_time > 0){
-        buzzer.beep(go_time*1000);
-        graphics.text_static("GO!", "Green");
-        state_isr.set_timer(countdown_a,go_time*1000);
+    // The match clock runs from GO, so the go message counts against the match time
+    match_clock.start();
+    log_event(JOURNAL_GO);
+    checkpoint();
+    if(config.go_time > 0){
+        buzzer.beep(config.go_time*1000);
+        graphics.text_static("GO!", COLOR_GREEN);
+        metrics_av_sync();
+        uint32_t go_end = min((uint32_t)config.go_time*1000, match_clock.remaining());
+        state_timer.set_timer_at(countdown, match_clock.started_at() + go_end);
     }else{
-        buzzer.beep(1000);
-        countdown_a();
+        buzzer.play(sounds[SOUND_LONG]);
+        countdown();
+        metrics_av_sync();
     }
 }
 
 // Display 1
 void pre_countdown_1(){
-    buzzer.beep(250);
-    graphics.text_static("1",color_pre);
-    state_isr.set_timer(pre_countdown_go,1000);
+    buzzer.play(sounds[SOUND_TICK]);
+    graphics.text_static("1",config.color_pre);
+    metrics_av_sync();
+    state_timer.set_timer(pre_countdown_go,1000);
 
 }
 
 // Display 2
 void pre_countdown_2(){
-    buzzer.beep(250);
-    graphics.text_static("2",color_pre);
-    state_isr.set_timer(pre_countdown_1,1000);
+    buzzer.play(sounds[SOUND_TICK]);
+    graphics.text_static("2",config.color_pre);
+    metrics_av_sync();
+    state_timer.set_timer(pre_countdown_1,1000);
 
 }
 
 // Display 3
 void pre_countdown_3(){
-    buzzer.beep(250);
-    graphics.text_static("3",color_pre);
-    state_isr.set_timer(pre_countdown_2,1000);
+    buzzer.play(sounds[SOUND_TICK]);
+    graphics.text_static("3",config.color_pre);
+    metrics_av_sync();
+    state_timer.set_timer(pre_countdown_2,1000);
 }
 
 // Display get ready message
 void pre_countdown_msg(){
     state = PRE;
-    if(pre_time > 0){
-        graphics.text_dynamic(msg_get_ready,color_pre);
-        state_isr.set_timer(pre_countdown_3,pre_time*1000);
+    checkpoint();
+    if(config.pre_time > 0){
+        graphics.text_dynamic(config.msg_get_ready,config.color_pre);
+        state_timer.set_timer(pre_countdown_3,config.pre_time*1000);
     }else{
         pre_countdown_3();
     }
@@ -177,18 +233,19 @@ void pre_countdown_msg(){
 
 // Set the time
 void ready(){
-    time_remaining = total_time - go_time + 1;
+    match_clock.set(total_time * 1000UL);
+    log_event(JOURNAL_START);
     pre_countdown_msg();
 }
 
 // Start rumble mode
 void rumble(){
-    graphics.text_dynamic(msg_rumble, "Red", ready);
+    graphics.text_dynamic(config.msg_rumble, COLOR_RED, ready);
 }
 
 // Display static clock
 void standby(){
-    graphics.text_static(format_time(total_time, true), color_timer);
+    graphics.text_static(format_time(total_time, true), config.color_timer);
     graphics.set_show_player_bar();
 }
 
@@ -197,20 +254,51 @@ void num_players(){
     state = STANDBY;
     switch(mode){
         case TWO_PLAYER:
-            graphics.text_dynamic("2 PLAYERS", "Blue", standby);
+            graphics.text_dynamic("2 PLAYERS", COLOR_BLUE, standby);
             break;
         case THREE_PLAYER:
-            graphics.text_dynamic("3 PLAYERS", "Green", standby);
+            graphics.text_dynamic("3 PLAYERS", COLOR_GREEN, standby);
             break;
         default:
-            graphics.text_dynamic("RUMBLE MODE", "Red", standby);
+            graphics.text_dynamic("RUMBLE MODE", COLOR_RED, standby);
             break;
     }
 }
 
 // Display intro message
 void intro(){
-    graphics.text_dynamic(msg_intro, color_intro, num_players);
+    graphics.text_dynamic(config.msg_intro, config.color_intro, num_players);
+}
+
+// Set the ready flags from a snapshot
+void restore_ready(const Snapshot& snapshot){
+    red_ready = snapshot.ready & 1;
+    blue_ready = snapshot.ready & 2;
+    green_ready = snapshot.ready & 4;
+    graphics.set_red_ready(red_ready);
+    graphics.set_blue_ready(blue_ready);
+    graphics.set_green_ready(green_ready);
+    graphics.set_three_players(snapshot.mode == THREE_PLAYER);
+    graphics.set_rumble_mode(snapshot.mode == RUMBLE);
+    graphics.set_show_player_bar();
+}
+
+// Display the time from a snapshot straight away, before settings are loaded
+void show_snapshot(const Snapshot& snapshot){
+    graphics.set_brightness(String(snapshot.brightness));
+    restore_ready(snapshot);
+    graphics.text_static(format_time((snapshot.remaining + 999) / 1000, true), snapshot.color_timer);
+    graphics.handle();
+}
+
+// Pick the match up from a snapshot, paused
+void resume_snapshot(const Snapshot& snapshot){
+    total_time = snapshot.total_time;
+    mode = snapshot.mode;
+    restore_ready(snapshot);
+    match_clock.set(snapshot.remaining);
+    log_event(JOURNAL_RECOVER);
+    pause();
 }
 /**
  *  ^ ^ ^ ^ ^ ^ ^ 
@@ -243,12 +331,10 @@ void check_players_ready(){
  * Handles black button press
  **/
 void black_btn_press(){
-    long start_time = millis();
-    bool reset_flag = false;
     switch(state){
         // Skip ahead during startup
         case STARTUP:
-            buzzer.beep_short();
+            buzzer.play(sounds[SOUND_SHORT]);
             num_players();
             break;
         case STANDBY:
@@ -256,35 +342,18 @@ void black_btn_press(){
             break;
         // Reset game during pre-countdown
         case PRE:
-            buzzer.beep(1000);
+            buzzer.play(sounds[SOUND_LONG]);
             reset();
             break;
-        // Pause game
+        // Pause game (the press that pauses can't also resume)
         case COUNTDOWN:
-            buzzer.beep(1000);
+            buzzer.play(sounds[SOUND_LONG]);
             pause();
-            break;
-        // Resume game or restart if button held for 3 seconds
-        case PAUSED:
-            while(btn_black.get()){
-                yield();
-                if(millis() > start_time + 3000){
-                    reset_flag = true;
-                    break;
-                }
-                btn_black.handle();
-            }
-            if(reset_flag){
-                buzzer.beep(250);
-                reset();
-            }else{
-                buzzer.beep_short();
-                pre_countdown_msg();
-            }
+            gestures.suppress(1 << PIN_BTN_BLACK);
             break;
         // Reset game after game over
         case GAME_OVER:
-            buzzer.beep(250);
+            buzzer.play(sounds[SOUND_TICK]);
             reset();
             break;
 
@@ -292,214 +361,244 @@ void black_btn_press(){
     }
 }
 
+/**
+ * Handles black button tap (resume game if paused)
+ **/
+void black_btn_tap(){
+    if(state != PAUSED) return;
+    graphics.show_progress(0);
+    buzzer.play(sounds[SOUND_SHORT]);
+    pre_countdown_msg();
+    log_event(JOURNAL_RESUME);
+}
+
+/**
+ * Handles black button held for the long press time (restart game if paused)
+ **/
+void black_btn_long_press(){
+    if(state != PAUSED) return;
+    graphics.show_progress(0);
+    buzzer.play(sounds[SOUND_TICK]);
+    reset();
+}
+
+/**
+ * Handles black button being held (show progress towards restart if paused)
+ * @param progress towards a long press (per mille)
+ **/
+void black_btn_hold(uint16_t progress){
+    if(state != PAUSED) return;
+    graphics.show_progress(progress);
+}
+
 /**
  * Handles green button press (only active during STANDBY state)
  **/
 void green_btn_press(){
-    switch(state){
-        case STANDBY:
-            // Set green player ready / not ready if in three player mode
-            if(!btn_black.get()){
-                if(mode == THREE_PLAYER){
-                    buzzer.beep_double();
-                    if(mode == RUMBLE){
-                        rumble();
-                    }else if(green_ready){
-                        green_ready = false;
-                        graphics.set_green_ready(false);
-                    } else {
-                        green_ready = true;
-                        graphics.set_green_ready(true);
-                        if(show_ready){
-                            graphics.text_dynamic("GREEN READY", "Green",check_players_ready);
-                        }else{
-                            check_players_ready();
-                        }
-                    }
-                }
-            // If black button being pressed, alt function is change time
+    if(state != STANDBY) return;
+    // Set green player ready / not ready if in three player mode
+    if(mode == THREE_PLAYER){
+        buzzer.play(sounds[SOUND_READY]);
+        if(green_ready){
+            green_ready = false;
+            graphics.set_green_ready(false);
+            log_event(JOURNAL_UNREADY, JOURNAL_GREEN);
+        } else {
+            green_ready = true;
+            graphics.set_green_ready(true);
+            log_event(JOURNAL_READY, JOURNAL_GREEN);
+            if(config.show_ready){
+                graphics.text_dynamic("GREEN READY", COLOR_GREEN,check_players_ready);
             }else{
-                buzzer.beep_short();
-                if(total_time + interval_time > max_time){
-                    total_time = min_time;
-                }else{
-                    total_time = total_time + interval_time;
-                }
-                ingame_settings.set("total_time", String(total_time));
-                standby();
+                check_players_ready();
             }
-            break;
-        
-        default:
-            break;
+        }
     }
 }
 
+/**
+ * Handles black + green buttons (change time, only active during STANDBY state)
+ **/
+void green_btn_alt(){
+    if(state != STANDBY) return;
+    buzzer.play(sounds[SOUND_SHORT]);
+    if(total_time + config.interval_time > config.max_time){
+        total_time = config.min_time;
+    }else{
+        total_time = total_time + config.interval_time;
+    }
+    ingame_settings.set("total_time", String(total_time));
+    log_event(JOURNAL_TIME, JOURNAL_GREEN);
+    standby();
+}
+
 /**
  * Handles blue button press (only active during STANDBY state)
  **/
 void blue_btn_press(){
-    switch(state){
-        case STANDBY:
-            // Set blue player ready / not ready
-            if(!btn_black.get()){
-                buzzer.beep_double();
-                if(mode == RUMBLE){
-                    rumble();
-                }else if(blue_ready){
-                    blue_ready = false;
-                    graphics.set_blue_ready(false);
-                } else {
-                    blue_ready = true;
-                    graphics.set_blue_ready(true);
-                    if(show_ready){
-                        graphics.text_dynamic("BLUE READY", "Blue", check_players_ready);
-                    }else{
-                        check_players_ready();
-                    }
-                }
-            // If black button being pressed, alt function is change brightness
-            }else{
-                buzzer.beep_short();
-                ingame_settings.set("brightness",String(graphics.change_brightness()));
-            }
-            break;
-        
-        default:
-            break;
+    if(state != STANDBY) return;
+    // Set blue player ready / not ready
+    buzzer.play(sounds[SOUND_READY]);
+    if(mode == RUMBLE){
+        log_event(JOURNAL_RUMBLE, JOURNAL_BLUE);
+        rumble();
+    }else if(blue_ready){
+        blue_ready = false;
+        graphics.set_blue_ready(false);
+        log_event(JOURNAL_UNREADY, JOURNAL_BLUE);
+    } else {
+        blue_ready = true;
+        graphics.set_blue_ready(true);
+        log_event(JOURNAL_READY, JOURNAL_BLUE);
+        if(config.show_ready){
+            graphics.text_dynamic("BLUE READY", COLOR_BLUE, check_players_ready);
+        }else{
+            check_players_ready();
+        }
     }
 }
 
+/**
+ * Handles black + blue buttons (change brightness, only active during STANDBY state)
+ **/
+void blue_btn_alt(){
+    if(state != STANDBY) return;
+    buzzer.play(sounds[SOUND_SHORT]);
+    ingame_settings.set("brightness",String(graphics.change_brightness()));
+    log_event(JOURNAL_BRIGHTNESS, JOURNAL_BLUE);
+}
+
 /**
  * Handles red button press (only active during STANDBY state)
  **/
 void red_btn_press(){
-    switch(state){
-        case STANDBY:
-            // Set red player ready / not ready
-            if(!btn_black.get()){
-                buzzer.beep_double();
-                if(mode == RUMBLE){
-                    rumble();
-                }else if(red_ready){
-                    red_ready = false;
-                    graphics.set_red_ready(false);
-                } else {
-                    red_ready = true;
-                    graphics.set_red_ready(true);
-                    if(show_ready){
-                        graphics.text_dynamic("RED READY", "Red",check_players_ready);
-                    }else{
-                        check_players_ready();
-                    }
-                }
-            // If black button being pressed, alt function is change number of players
-            }else{
-                buzzer.beep_short();
-                switch(mode){
-                    case(TWO_PLAYER):
-                        mode = THREE_PLAYER;
-                        ingame_settings.set("mode", "1");
-                        break;
-                    case(THREE_PLAYER):
-                        mode = RUMBLE;
-                        ingame_settings.set("mode", "2");
-                        break;
-                    default:
-                        mode = TWO_PLAYER;
-                        ingame_settings.set("mode", "0");
-                        break;      
-                }
-                red_ready = false;
-                blue_ready = false;
-                green_ready = false;
-                graphics.set_three_players(mode == THREE_PLAYER);
-                graphics.set_rumble_mode(mode == RUMBLE);
-                num_players();
-            }
-            break;
-        
-        default:
-            break;
+    if(state != STANDBY) return;
+    // Set red player ready / not ready
+    buzzer.play(sounds[SOUND_READY]);
+    if(mode == RUMBLE){
+        log_event(JOURNAL_RUMBLE, JOURNAL_RED);
+        rumble();
+    }else if(red_ready){
+        red_ready = false;
+        graphics.set_red_ready(false);
+        log_event(JOURNAL_UNREADY, JOURNAL_RED);
+    } else {
+        red_ready = true;
+        graphics.set_red_ready(true);
+        log_event(JOURNAL_READY, JOURNAL_RED);
+        if(config.show_ready){
+            graphics.text_dynamic("RED READY", COLOR_RED,check_players_ready);
+        }else{
+            check_players_ready();
+        }
     }
 }
 
 /**
- * Load settings from settings file
+ * Handles black + red buttons (change number of players, only active during STANDBY state)
  **/
-void load_settings(){
-
-    // General Settings
-    msg_intro = webinterface.load_setting("msg_intro");
-    color_intro = webinterface.load_setting("color_intro");
-    color_pre = webinterface.load_setting("color_pre");
-    color_timer = webinterface.load_setting("color_timer");
-    graphics.set_show_aux_lights(webinterface.load_setting("show_aux_lights") == "true");
-    graphics.set_show_dim_lights(webinterface.load_setting("show_dim_lights") == "true");
-    show_ready = webinterface.load_setting("show_ready") == "true";
-    msg_rumble = webinterface.load_setting("msg_rumble");
-    msg_get_ready = webinterface.load_setting("msg_get_ready");
-    msg_game_over = webinterface.load_setting("msg_game_over");
-
-
-    // Advanced Settings
-    String min_time_string = webinterface.load_setting("min_time");
-    if(min_time_string == "0:15"){
-        min_time = 15;
-    }else if(min_time_string == "0:45"){
-        min_time = 45;
-    }else if(min_time_string == "1:00"){
-        min_time = 60;
-    }else if(min_time_string == "1:30"){
-        min_time = 90;
-    }else{
-        min_time = 30;
+void red_btn_alt(){
+    if(state != STANDBY) return;
+    buzzer.play(sounds[SOUND_SHORT]);
+    switch(mode){
+        case(TWO_PLAYER):
+            mode = THREE_PLAYER;
+            ingame_settings.set("mode", "1");
+            break;
+        case(THREE_PLAYER):
+            mode = RUMBLE;
+            ingame_settings.set("mode", "2");
+            break;
+        default:
+            mode = TWO_PLAYER;
+            ingame_settings.set("mode", "0");
+            break;      
     }
+    red_ready = false;
+    blue_ready = false;
+    green_ready = false;
+    graphics.set_three_players(mode == THREE_PLAYER);
+    graphics.set_rumble_mode(mode == RUMBLE);
+    num_players();
+    log_event(JOURNAL_MODE, JOURNAL_RED);
+}
 
-    String max_time_string = webinterface.load_setting("max_time");
-    if(max_time_string == "2:00"){
-        max_time = 120;
-    }else if(max_time_string == "4:00"){
-        max_time = 240;
-    }else if(max_time_string == "5:00"){
-        max_time = 300;
-    }else{
-        max_time = 180;
+/**
+ * Send button gestures to their handlers
+ * @param gesture from the gesture engine
+ **/
+void on_gesture(const Gesture& gesture){
+    // Journal presses before they are handled, so what they led to comes after them
+    if(gesture.type == GESTURE_PRESS || gesture.type == GESTURE_CHORD){
+        if(gesture.pin == PIN_BTN_BLACK) log_press(btn_black, JOURNAL_BLACK);
+        if(gesture.pin == PIN_BTN_BLUE) log_press(btn_blue, JOURNAL_BLUE);
+        if(gesture.pin == PIN_BTN_RED) log_press(btn_red, JOURNAL_RED);
+        if(gesture.pin == PIN_BTN_GREEN) log_press(btn_green, JOURNAL_GREEN);
     }
 
-    String interval_time_string = webinterface.load_setting("interval_time");
-    if(interval_time_string == "0:01"){
-        interval_time = 1;
-    }else if(interval_time_string == "0:02"){
-        interval_time = 2;
-    }else if(interval_time_string == "0:05"){
-        interval_time = 5;
-    }else if(interval_time_string == "0:10"){
-        interval_time = 10;
-    }else if(interval_time_string == "0:30"){
-        interval_time = 30;
-    }else{
-        interval_time = 15;
+    switch(gesture.type){
+        case GESTURE_PRESS:
+            if(gesture.pin == PIN_BTN_BLACK) black_btn_press();
+            if(gesture.pin == PIN_BTN_BLUE) blue_btn_press();
+            if(gesture.pin == PIN_BTN_RED) red_btn_press();
+            if(gesture.pin == PIN_BTN_GREEN) green_btn_press();
+            break;
+        // Black is the modifier, so chords are black + a color
+        case GESTURE_CHORD:
+            if(gesture.pin == PIN_BTN_BLUE) blue_btn_alt();
+            if(gesture.pin == PIN_BTN_RED) red_btn_alt();
+            if(gesture.pin == PIN_BTN_GREEN) green_btn_alt();
+            break;
+        case GESTURE_TAP:
+            if(gesture.pin == PIN_BTN_BLACK) black_btn_tap();
+            break;
+        case GESTURE_HOLD:
+            if(gesture.pin == PIN_BTN_BLACK) black_btn_hold(gesture.progress);
+            break;
+        case GESTURE_LONG_PRESS:
+            if(gesture.pin == PIN_BTN_BLACK) black_btn_long_press();
+            break;
+        default: break;
     }
+}
 
-    String pre_time_string = webinterface.load_setting("pre_time");
-    if(pre_time_string == "Off") pre_time = 0;
-    else if(pre_time_string == "") pre_time = 5;
-    else pre_time = pre_time_string.substring(0,1).toInt();
+/**
+ * Start timestamping button edges with interrupts
+ **/
+void buttons_begin(){
+    btn_black.begin();
+    btn_blue.begin();
+    btn_red.begin();
+    btn_green.begin();
+}
 
-    String go_time_string = webinterface.load_setting("go_time");
-    if(go_time_string == "Off") go_time = 0;
-    else if(go_time_string == "") go_time = 2;
-    else go_time = go_time_string.substring(0,1).toInt();
+/**
+ * Stop timestamping button edges with interrupts (buttons are still scanned)
+ **/
+void buttons_end(){
+    btn_black.end();
+    btn_blue.end();
+    btn_red.end();
+    btn_green.end();
+}
 
-    String game_over_time_string = webinterface.load_setting("game_over_time");
-    if(game_over_time_string == "Off") game_over_time = 0;
-    else if(game_over_time_string == "") game_over_time = 5;
-    else game_over_time = game_over_time_string.substring(0,1).toInt();
+/**
+ * Load settings from settings file
+ **/
+void load_settings(){
+    // Settings file
+    load_config(config, webinterface);
 
-    auto_reset = webinterface.load_setting("auto_reset") == "true";
-    buzzer.set_buzzer_on(webinterface.load_setting("buzzer_on") != "false");
+    graphics.set_show_aux_lights(config.show_aux_lights);
+    graphics.set_show_dim_lights(config.show_dim_lights);
+    graphics.set_scroll_speed(config.scroll_speed);
+    buzzer.set_buzzer_on(config.buzzer_on);
 
+    // Render the configured messages ahead of time
+    graphics.prewarm_text(config.msg_intro);
+    graphics.prewarm_text(config.msg_get_ready);
+    graphics.prewarm_text(config.msg_game_over);
+    graphics.prewarm_text(config.msg_rumble);
 
     // In-Game Settings
     String total_time_string = (ingame_settings.get("total_time"));
@@ -508,8 +607,8 @@ void load_settings(){
     }else{
         total_time = total_time_string.toInt();
     } 
-    if(total_time > max_time) total_time = max_time;
-    if(total_time < min_time) total_time = min_time;
+    if(total_time > config.max_time) total_time = config.max_time;
+    if(total_time < config.min_time) total_time = config.min_time;
 
     graphics.set_brightness(ingame_settings.get("brightness"));
 
@@ -520,29 +619,110 @@ void load_settings(){
 }
 
 /**
- * WiFi setup mode loops until restart
+ * Start the WiFi hotspot
  **/
-void wifi_setup(){
-    // Display a static wifi symbol on the displays
-    graphics.show_wifi();
-
-    // Start a hotspot
+void start_hotspot(){
     WiFi.persistent(false);
     WiFi.mode(WIFI_AP);
     WiFi.softAPConfig(IPAddress(1,2,3,4),IPAddress(1,2,3,4),IPAddress(255,255,255,0));
 
-    // Load SSID and password settings
-    String SSID = webinterface.load_setting("hotspot_SSID");
-    if(SSID == ""){
+    // Set SSID and password from settings
+    if(config.hotspot_ssid == ""){
         WiFi.softAP("battlebricks","12345678");
     }else{
-        String password = webinterface.load_setting("hotspot_password");
-        if(password.length() < 8){
-            WiFi.softAP(SSID);
+        if(config.hotspot_password.length() < 8){
+            WiFi.softAP(config.hotspot_ssid);
         }else{
-            WiFi.softAP(SSID, password);
+            WiFi.softAP(config.hotspot_ssid, config.hotspot_password);
         }
     }
+}
+
+#ifdef BENCHMARK
+Persistent_Storage bench_storage("bench");
+
+#ifdef PERSISTENT_STORAGE_LOG
+const char* bench_pref_path = "/pref.log";
+#else
+const char* bench_pref_path = "/pref.txt";
+#endif
+
+/**
+ * Read a whole file in chunks, the way the web server and settings parser do
+ * @param path of the file
+ **/
+void bench_read_file(const char* path){
+    uint8_t buffer[256];
+    File file = storage.open(path, "r");
+    if(!file) return;
+    while(file.read(buffer, sizeof(buffer)) > 0);
+    file.close();
+}
+
+/**
+ * Replace a file with one the size of the in-game settings
+ * @param path of the file
+ **/
+void bench_write_file(const char* path){
+    File file = storage.open(path, "w");
+    file.print("{\"total_time\":\"180\",\"brightness\":\"2\",\"mode\":\"0\"}");
+    file.close();
+}
+
+/**
+ * Wait until the displays can take a new frame, then change the text
+ * @param iteration number
+ **/
+void bench_prepare_frame(uint16_t iteration){
+    uint32_t handled = graphics.get_frames_pushed() + graphics.get_frames_skipped();
+    while(graphics.get_frames_pushed() + graphics.get_frames_skipped() == handled){
+        graphics.handle();
+        yield();
+    }
+    graphics.text_static(format_time(iteration % 600, iteration & 1), config.color_timer);
+}
+
+/**
+ * Time the hot paths that need the hardware (displays, flash) and print the results over 
+ * Serial. The ones that only need the CPU run on the host, in test/test_benchmarks.
+ **/
+void run_benchmarks(){
+    benchmark_header();
+
+    benchmark("graphics_handle_frame", 100, [](uint16_t){ graphics.handle(); }, 
+        bench_prepare_frame);
+    benchmark("graphics_handle_idle", 1000, [](uint16_t){ graphics.handle(); });
+    uint32_t written = Persistent_Storage::get_bytes_written();
+    benchmark("storage_commit", 20, [](uint16_t i){ 
+        bench_storage.set("key", String(i)); 
+        bench_storage.flush(); 
+    });
+    benchmark_count("storage_commit", 20, "flash_bytes", 
+        Persistent_Storage::get_bytes_written() - written);
+
+    // The web server looks for a gzipped copy of every file first, which is usually a miss
+    benchmark("fs_exists_settings", 20, [](uint16_t){ storage.exists("/settings.txt"); });
+    benchmark("fs_exists_gz_miss", 20, [](uint16_t){ storage.exists("/www/index.html.gz"); });
+    benchmark("fs_open_settings", 20, [](uint16_t){ storage.open("/settings.txt", "r").close(); });
+    benchmark("fs_read_settings", 20, [](uint16_t){ bench_read_file("/settings.txt"); });
+    benchmark("fs_read_pref", 20, [](uint16_t){ bench_read_file(bench_pref_path); });
+    benchmark("fs_read_gz_asset", 20, [](uint16_t){ bench_read_file("/www/lib/jq.js.gz"); });
+    benchmark("fs_write_pref", 20, [](uint16_t){ bench_write_file("/bench.bin"); });
+
+    storage.remove("/bench.txt");
+    storage.remove("/bench.log");
+    storage.remove("/bench.bin");
+}
+#endif
+
+/**
+ * WiFi setup mode loops until restart
+ **/
+void wifi_setup(){
+    // Display a static wifi symbol on the displays
+    graphics.show_wifi();
+
+    start_hotspot();
 
     // Initialize OTA
     ArduinoOTA.setHostname("battlebricks");
@@ -566,7 +746,7 @@ void wifi_setup(){
             }
             // If black button is pressed for 10 seconds, factory reset
             if(millis() >= button_pressed_time + 10000){
-                SPIFFS.remove("/settings.txt");
+                storage.remove("/settings.txt");
                 ESP.restart();
             }
         }else if(!digitalRead(PIN_BTN_BLACK)){
@@ -584,36 +764,86 @@ void wifi_setup(){
  * 
  * */
 void setup(){
-    // Set button callbacks
-    btn_black.set_posedge_cb(black_btn_press);
-    btn_blue.set_posedge_cb(blue_btn_press);
-    btn_green.set_posedge_cb(green_btn_press);
-    btn_red.set_posedge_cb(red_btn_press);
+#if defined(PROFILE) || defined(BENCHMARK) || defined(SIMULATE)
+    // Display 1 uses UART1, so Serial must be TX only
+    Serial.begin(115200, SERIAL_8N1, SERIAL_TX_ONLY);
+#endif
+#ifdef PROFILE
+    profiler.begin(profile_stage_names, PROF_STAGES);
+#endif
+
+    // Watch timers from the hardware timer interrupt
+    scheduler.begin();
+
+    // Initialize displays and LEDs
+    graphics.begin();
+
+    // After a reset mid-match, show the time before doing anything slow (like parsing settings)
+    Snapshot snapshot;
+    bool resume = snapshot_load(snapshot) && 
+        (snapshot.state == PRE || snapshot.state == COUNTDOWN || snapshot.state == PAUSED);
+    if(resume) show_snapshot(snapshot);
+
+    // Debounce all buttons together, and timestamp their edges with interrupts
+    scanner.add(btn_black);
+    scanner.add(btn_blue);
+    scanner.add(btn_red);
+    scanner.add(btn_green);
+    buttons_begin();
+
+    // Turn button states into gestures, black + color is a chord and holding black restarts when paused
+    gestures.set_callback(on_gesture);
+    gestures.set_long_time(3000);
+    gestures.set_modifiers(1 << PIN_BTN_BLACK);
   
     // Initialize web interface
     webinterface.begin();
+    // Settings are written in the background, so write them before the web interface restarts
+    webinterface.set_restart_callback(Persistent_Storage::flush_all);
 
-    // Initialize displays and LEDs
-    graphics.begin();
+    // Load settings
+    load_settings();
+
+#ifdef BENCHMARK
+    run_benchmarks();
+#endif
+
+    // Serve runtime metrics and the match journal, before WiFi setup mode so it serves them too
+    metrics_begin(webinterface, graphics, buzzer, config);
+    journal_begin(webinterface);
+    log_event(JOURNAL_BOOT);
 
     // If black button held during start up, enter wifi setup mode
     if(!digitalRead(PIN_BTN_BLACK)){
         wifi_setup();
     }
 
-    // Disable wifi and load settings
-    WiFi.mode(WIFI_OFF);
-    load_settings();
+    // The hotspot and web interface are only up during play if the settings ask for it (and 
+    // the displays don't block interrupts), as anyone on the hotspot can change settings
+    if(config.wifi_during_play && !graphics.output_blocking()){
+        start_hotspot();
+        wifi_on = true;
+    }else{
+        WiFi.mode(WIFI_OFF);
+    }
 
-    // Startup beep
-    buzzer.beep(500);
-    
-    // Display intro message or skip to displaying the number of players if blank
-    if(msg_intro == ""){
-        num_players();
+    if(resume){
+        // Go straight back to the match, paused
+        resume_snapshot(snapshot);
     }else{
-        intro();
+        // Startup beep
+        buzzer.play(sounds[SOUND_BOOT]);
+        
+        // Display intro message or skip to displaying the number of players if blank
+        if(config.msg_intro == ""){
+            num_players();
+        }else{
+            intro();
+        }
     }
+
+    // Any button wakes the timer from light sleep
+    idle_begin(button_pins, sizeof(button_pins), buttons_end, buttons_begin);
     
 }   
 
@@ -623,16 +853,43 @@ void setup(){
  * 
  * */
 void loop(){
-    // Handle time-based interrupts
-    state_isr.handle();
-    buzzer_isr.handle();
+    metrics_loop();
+    PROFILE_START(PROF_LOOP);
+
+    // Run timers that are due
+    PROFILE_START(PROF_SCHEDULER);
+    scheduler.handle();
+    PROFILE_END(PROF_SCHEDULER);
 
     // Handle button inputs
-    btn_black.handle();
-    btn_blue.handle();
-    btn_red.handle();
-    btn_green.handle();
+    PROFILE_START(PROF_INPUT);
+    scanner.handle();
+    gestures.handle();
+    PROFILE_END(PROF_INPUT);
 
     graphics.handle();
-    buzzer.handle();
+
+    PROFILE_START(PROF_WEB);
+    if(wifi_on) webinterface.handle();
+    PROFILE_END(PROF_WEB);
+
+    // Write in-game settings once they stop changing
+    ingame_settings.handle();
+
+    PROFILE_END(PROF_LOOP);
+
+    // Give the CPU back until something needs the loop
+    uint32_t time_to_next = min(min(scheduler.time_to_next(), scanner.time_to_next()), 
+        min(graphics.time_to_next(), gestures.time_to_next()));
+    time_to_next = min(time_to_next, ingame_settings.time_to_next());
+    idle(time_to_next, !wifi_on);
+
+#ifdef PROFILE
+    if(profiler.handle()){
+#ifdef PROFILE_OVERLAY
+        graphics.set_profile_overlay(profiler);
+#endif
+        profiler.reset();
+    }
+#endif
 }
\ No newline at end of file
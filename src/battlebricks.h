@@ -20,15 +20,23 @@
  **/
 #include "Arduino.h"
 
+#include "states.h"
 #include "graphics.h"
+#include "config.h"
+#include "match_clock.h"
+#include "metrics.h"
+#include "journal.h"
+#include "snapshot.h"
+#include "idle.h"
+#include "benchmark.h"
 
 #include "Persistent_Storage.h"
-#include "Button.h"
+#include "Gesture_Engine.h"
 #include "ESP8266WiFi.h"
 #include "ESP8266WiFiMulti.h"
 #include "ArduinoOTA.h"
 #include "Web_Interface.h"
-#include "Buzzer.h"
+#include "sounds.h"
 
 // Input/Output Pins
 #define PIN_BTN_RED     14
@@ -37,46 +45,17 @@
 #define PIN_BTN_GREEN   0
 #define PIN_BUZZER      15
 
-// States
-#define STARTUP     0
-#define STANDBY     1
-#define PRE         2
-#define COUNTDOWN   3
-#define PAUSED      4
-#define GAME_OVER   5
-
 uint8_t state = STARTUP;
 
-// Modes
-#define TWO_PLAYER      0
-#define THREE_PLAYER    1
-#define RUMBLE          2
-
 // In-game settings
 uint16_t total_time;
 uint8_t mode;
 
 // Settings from settings file
-String msg_intro;
-String color_intro;
-String color_pre;
-String color_timer;
-String msg_rumble;
-String msg_get_ready;
-String msg_game_over;
-bool show_ready;
-bool buzzer_on;
-
-uint16_t min_time;
-uint16_t max_time;
-uint8_t interval_time;
-uint8_t pre_time;
-uint8_t go_time;
-uint8_t game_over_time;
-bool auto_reset;
+Config config;
 
 // Game Status
-int16_t time_remaining;
+Match_Clock match_clock;
 bool blue_ready = false;
 bool red_ready = false;
 bool green_ready = false;
@@ -0,0 +1,60 @@
+/**
+ * Benchmarks for Battlebricks Timer
+ * Build with -D BENCHMARK to time functions on the device at boot, or run 
+ * "pio test -e native -f test_benchmarks -v" to time the ones that don't need the hardware
+ * on the host. Results are printed over Serial as CSV lines: 
+ * "bench,<name>,<iterations>,<mean_us>,<min_us>,<max_us>", and any counted amounts as 
+ * "bench_count,<name>,<iterations>,<unit>,<per_iteration>"
+ **/
+#include "benchmark.h"
+
+/**
+ * Print the CSV header
+ **/
+void benchmark_header(){
+    Serial.println("bench,name,iterations,mean_us,min_us,max_us");
+}
+
+/**
+ * Time a function and print the results
+ * @param name of benchmark
+ * @param iterations to time
+ * @param function to time, called with the iteration number
+ * @param prepare (optional) untimed function called before each iteration
+ **/
+void benchmark(const char* name, uint16_t iterations, bench_function function, 
+        bench_function prepare){
+    uint32_t total = 0;
+    uint32_t fastest = 0xFFFFFFFF;
+    uint32_t slowest = 0;
+
+    for(uint16_t i = 0; i < iterations; i++){
+        if(prepare) prepare(i);
+
+        uint32_t start = micros();
+        function(i);
+        uint32_t elapsed = micros() - start;
+
+        total += elapsed;
+        if(elapsed < fastest) fastest = elapsed;
+        if(elapsed > slowest) slowest = elapsed;
+
+        // Keep the watchdog and WiFi stack fed between iterations
+        yield();
+    }
+
+    if(iterations == 0) return;
+    Serial.printf("bench,%s,%u,%u,%u,%u\n", name, iterations, total / iterations, fastest, slowest);
+}
+
+/**
+ * Print an amount counted over a benchmark (e.g. bytes written)
+ * @param name of benchmark
+ * @param iterations it ran for
+ * @param unit of amount
+ * @param total amount over all iterations
+ **/
+void benchmark_count(const char* name, uint16_t iterations, const char* unit, uint32_t total){
+    if(iterations == 0) return;
+    Serial.printf("bench_count,%s,%u,%s,%u\n", name, iterations, unit, total / iterations);
+}
@@ -0,0 +1,16 @@
+/**
+ * Benchmarks for Battlebricks Timer
+ * Build with -D BENCHMARK to time functions on the device at boot, or run 
+ * "pio test -e native -f test_benchmarks -v" to time the ones that don't need the hardware
+ * on the host. Results are printed over Serial as CSV lines: 
+ * "bench,<name>,<iterations>,<mean_us>,<min_us>,<max_us>", and any counted amounts as 
+ * "bench_count,<name>,<iterations>,<unit>,<per_iteration>"
+ **/
+#include "Arduino.h"
+
+typedef void (*bench_function)(uint16_t iteration);
+
+void benchmark_header();
+void benchmark(const char* name, uint16_t iterations, bench_function function, 
+    bench_function prepare = NULL);
+void benchmark_count(const char* name, uint16_t iterations, const char* unit, uint32_t total);
@@ -0,0 +1,150 @@
+/**
+ * Settings for Battlebricks Timer
+ * Parses the settings file once at boot into a typed, validated snapshot.
+ **/
+#include "config.h"
+#include "graphics.h"
+#include "Web_Interface.h"
+
+// Config being loaded
+Config* loading_config;
+
+/**
+ * Parse a clock time setting
+ * @param input time formatted "m:ss"
+ * @param default_time if the input is blank or out of range
+ * @param min_time valid range (seconds)
+ * @param max_time valid range (seconds)
+ * @return time in seconds
+ **/
+uint16_t parse_clock(String input, uint16_t default_time, uint16_t min_time, uint16_t max_time){
+    int16_t colon = input.indexOf(':');
+    if(colon < 0) return default_time;
+
+    uint16_t time = input.substring(0, colon).toInt() * 60 + input.substring(colon + 1).toInt();
+    if(time < min_time || time > max_time) return default_time;
+    return time;
+}
+
+/**
+ * Parse a duration setting
+ * @param input duration formatted "N Seconds" or "Off"
+ * @param default_time if the input is blank
+ * @return time in seconds
+ **/
+uint8_t parse_seconds(String input, uint8_t default_time){
+    if(input == "Off") return 0;
+    if(input == "") return default_time;
+    return input.substring(0,1).toInt();
+}
+
+/**
+ * Parse a number setting
+ * @param input number
+ * @param default_value if the input is blank
+ * @param min_value valid range
+ * @param max_value valid range
+ * @return number, clamped to the valid range
+ **/
+uint16_t parse_number(String input, uint16_t default_value, uint16_t min_value, 
+    uint16_t max_value){
+    if(input == "") return default_value;
+    long value = input.toInt();
+    if(value < min_value) return min_value;
+    if(value > max_value) return max_value;
+    return value;
+}
+
+/**
+ * Parse color from string
+ * @param input color with first char capitalized from ["Blue","White","Green","Cyan","Magenta",
+ *                                                      "Yellow","Red"]
+ * @return Palette color from [COLOR_BLUE,COLOR_WHITE,...] (Default COLOR_RED)
+ **/
+uint8_t parse_color(String input){
+    if(input == "Blue") return COLOR_BLUE;
+    if(input == "White") return COLOR_WHITE;
+    if(input == "Green") return COLOR_GREEN;
+    if(input == "Cyan") return COLOR_CYAN;
+    if(input == "Magenta") return COLOR_MAGENTA;
+    if(input == "Yellow") return COLOR_YELLOW;
+    return COLOR_RED;
+}
+
+/**
+ * Store one setting from the settings file
+ * @param id of setting
+ * @param val of setting
+ **/
+void config_setting(const String& id, const String& val){
+    Config& config = *loading_config;
+
+    // General Settings
+    if(id == "msg_intro") config.msg_intro = val;
+    else if(id == "msg_rumble") config.msg_rumble = val;
+    else if(id == "msg_get_ready") config.msg_get_ready = val;
+    else if(id == "msg_game_over") config.msg_game_over = val;
+    else if(id == "color_intro") config.color_intro = parse_color(val);
+    else if(id == "color_pre") config.color_pre = parse_color(val);
+    else if(id == "color_timer") config.color_timer = parse_color(val);
+    else if(id == "show_aux_lights") config.show_aux_lights = (val == "true");
+    else if(id == "show_dim_lights") config.show_dim_lights = (val == "true");
+    else if(id == "show_ready") config.show_ready = (val == "true");
+    else if(id == "buzzer_on") config.buzzer_on = (val != "false");
+
+    // Advanced Settings
+    else if(id == "min_time") config.min_time = parse_clock(val, 30, 15, 90);
+    else if(id == "max_time") config.max_time = parse_clock(val, 180, 120, 300);
+    else if(id == "interval_time") config.interval_time = parse_clock(val, 15, 1, 30);
+    else if(id == "pre_time") config.pre_time = parse_seconds(val, 5);
+    else if(id == "go_time") config.go_time = parse_seconds(val, 2);
+    else if(id == "game_over_time") config.game_over_time = parse_seconds(val, 5);
+    else if(id == "scroll_speed") config.scroll_speed = parse_number(val, SCROLL_SPEED, 30, 80);
+    else if(id == "auto_reset") config.auto_reset = (val == "true");
+
+    // WiFi Settings
+    else if(id == "hotspot_SSID") config.hotspot_ssid = val;
+    else if(id == "hotspot_password") config.hotspot_password = val;
+    else if(id == "wifi_during_play") config.wifi_during_play = (val == "true");
+}
+
+/**
+ * Load all settings with a single pass over the settings file. Settings missing from the 
+ * file keep their defaults.
+ * @param config to load into
+ * @param webinterface that owns the settings file
+ **/
+void load_config(Config& config, Web_Interface& webinterface){
+    uint32_t start_time = micros();
+
+    config.msg_intro = "";
+    config.msg_rumble = "";
+    config.msg_get_ready = "";
+    config.msg_game_over = "";
+    config.color_intro = COLOR_RED;
+    config.color_pre = COLOR_RED;
+    config.color_timer = COLOR_RED;
+    config.show_aux_lights = false;
+    config.show_dim_lights = false;
+    config.show_ready = false;
+    config.buzzer_on = true;
+
+    config.min_time = 30;
+    config.max_time = 180;
+    config.interval_time = 15;
+    config.pre_time = 5;
+    config.go_time = 2;
+    config.game_over_time = 5;
+    config.scroll_speed = SCROLL_SPEED;
+    config.auto_reset = false;
+
+    config.hotspot_ssid = "";
+    config.hotspot_password = "";
+    config.wifi_during_play = false;
+
+    loading_config = &config;
+    webinterface.load_settings(config_setting);
+
+    config.load_time = micros() - start_time;
+    config.loaded_at = millis();
+}
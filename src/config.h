@@ -0,0 +1,44 @@
+/**
+ * Settings for Battlebricks Timer
+ * Parses the settings file once at boot into a typed, validated snapshot.
+ **/
+#include "Arduino.h"
+
+class Web_Interface;
+
+struct Config{
+    // General settings
+    String msg_intro;
+    String msg_rumble;
+    String msg_get_ready;
+    String msg_game_over;
+    uint8_t color_intro;
+    uint8_t color_pre;
+    uint8_t color_timer;
+    bool show_aux_lights;
+    bool show_dim_lights;
+    bool show_ready;
+    bool buzzer_on;
+
+    // Advanced settings (times in seconds)
+    uint16_t min_time;
+    uint16_t max_time;
+    uint8_t interval_time;
+    uint8_t pre_time;
+    uint8_t go_time;
+    uint8_t game_over_time;
+    uint8_t scroll_speed;
+    bool auto_reset;
+
+    // WiFi settings
+    String hotspot_ssid;
+    String hotspot_password;
+    bool wifi_during_play;
+
+    // Time taken to load the settings (us) and when they were loaded (ms)
+    uint32_t load_time;
+    uint32_t loaded_at;
+};
+
+void load_config(Config& config, Web_Interface& webinterface);
+uint8_t parse_color(String input);
@@ -6,9 +6,14 @@
  **/
 #include "graphics.h"
 
-Soft_ISR isr;
+Soft_Timer scroll_timer;
+Soft_Timer brightness_timer;
 bool show_brightness;
 
+// Canvas pixel to strip index for each display
+constexpr Pixel_Map<FRAME_WIDTH, FRAME_HEIGHT, 16, 16, DISPLAY1_LAYOUT> display_1_map;
+constexpr Pixel_Map<PLAYER_WIDTH, PLAYER_HEIGHT, 8, 8, DISPLAY2_LAYOUT> display_2_map;
+
 /**
  * Set show brightness off
  **/
@@ -29,8 +34,8 @@ void Graphics::begin() {
     digitalWrite(PIN_LED_RED, LOW);
 
     // Initialize Matrix displays
-    display_1.begin();
-    display_2.begin();
+    output_1.begin();
+    output_2.begin();
     update_brightness();
 }
 
@@ -38,60 +43,98 @@ void Graphics::begin() {
  * Handle all graphics updates (run every loop)
  **/
 void Graphics::handle() {
+    // Wait for the previous frame to finish sending
+    if(output_1.busy() || output_2.busy()) return;
+
+    // Update layers whose inputs have changed
+    PROFILE_START(PROF_GFX_TEXT);
+    update_text();
+    PROFILE_END(PROF_GFX_TEXT);
+
+    PROFILE_START(PROF_GFX_BARS);
+    if(bar_dirty) render_bar_layer();
+    PROFILE_END(PROF_GFX_BARS);
+
+    if(overlay_dirty) render_overlay_layer();
+    if(show_brightness != overlay_shown){
+        overlay_shown = show_brightness;
+        frame_dirty = true;
+    }
 
-    isr.handle();
-    // Clear Displays
-    display_1.clear();
-    display_2.clear();
-
-    // Draw brightness display
-    if(show_brightness){
-        draw_brightness();
-    } else {
-        // Draw text
-        draw_text();
-        // Draw player ready bars
-        if(show_player_bar) draw_players_ready();
-    };
-
-    // Refresh display
-    display_1.show();
-    display_2.show();
+    // Recompose and refresh the displays only if a layer changed
+    if(frame_dirty){
+        frame_dirty = false;
+        PROFILE_START(PROF_GFX_COMPOSE);
+        compose();
+        PROFILE_END(PROF_GFX_COMPOSE);
+        pushed_at = clock_micros();
+        if(frames_pushed == 0) first_pushed_at = micros();
+        push_frame();
+        frames_pushed++;
+    }else{
+        frames_skipped++;
+    }
 }
 
 /**
  * Set new static text
  * @param text to display
- * @param color of text
+ * @param color of text (palette index)
  **/
-void Graphics::text_static(String text, String color){
+void Graphics::text_static(String text, uint8_t color){
     text_scroll = false;
     text_xpos = 15 - (text.length() * 3);
-    text_color = parse_color(color);
+    text_color = palette[color];
     text_string = text;
+    text_strip = text_cache.get_static(text);
+    text_cache.hold(text_strip);
+    scroll_timer.remove();
+    frame_dirty = true;
 }
 
 /**
  * Set new dynamic text
  * @param text to display
- * @param color of text
+ * @param color of text (palette index)
  **/
-void Graphics::text_dynamic(String text, String color){
+void Graphics::text_dynamic(String text, uint8_t color){
     text_xpos = 32;
-    text_color = parse_color(color);
+    text_color = palette[color];
     text_string = text;
+    text_strip = text_cache.get(text);
+    text_cache.hold(text_strip);
     text_scroll = true;
+    scroll_timer.remove();
+    frame_dirty = true;
+    scroll_last_step = clock_millis();
 }
 
 /**
  * Set new dynamic text
  * @param text to display
- * @param color of text
+ * @param color of text (palette index)
  * @param _callback function to call after text has fully scrolled
  **/
-void Graphics::text_dynamic(String text, String color, void_function_pointer _callback){
+void Graphics::text_dynamic(String text, uint8_t color, void_function_pointer _callback){
     text_dynamic(text, color);
-    isr.set_trigger(_callback);
+    scroll_timer.set_trigger(_callback);
+}
+
+/**
+ * Render text ahead of time so showing it later costs nothing
+ * @param text to render
+ **/
+void Graphics::prewarm_text(String text){
+    text_cache.prewarm(text);
+}
+
+/**
+ * Set text scroll speed
+ * @param speed in pixels per second (0 for default)
+ **/
+void Graphics::set_scroll_speed(uint8_t speed){
+    if(speed == 0) speed = SCROLL_SPEED;
+    scroll_step_time = 1000 / speed;
 }
 
 /**
@@ -109,6 +152,13 @@ void Graphics::set_brightness(String input){
     update_brightness();
 }
 
+/**
+ * @return brightness number [1,8]
+ **/
+uint8_t Graphics::get_brightness(){
+    return brightness;
+}
+
 /**
  * Increase brightness by 1 or rollover from 8 to 1
  * @return new brightness number [1,8]
@@ -122,7 +172,7 @@ uint8_t Graphics::change_brightness() {
     update_brightness();
     
     show_brightness = true;
-    isr.set_timer(show_brightness_off,1000);
+    brightness_timer.set_timer(show_brightness_off,1000);
 
     return brightness;
 }
@@ -131,22 +181,110 @@ uint8_t Graphics::change_brightness() {
  * Display a static wifi symbol
  **/
 void Graphics::show_wifi() {
-    display_1.clear();
-    display_2.clear();
-    display_1.setBrightness(32);
-    display_2.setBrightness(24);
-    display_1.drawBitmap(8,3,bmp_wifi_l,16,9,CYAN);
-    display_2.drawBitmap(4,0,bmp_wifi_s,8,8,CYAN);
-    display_1.show();
-    display_2.show();
+    frame.fill(BLACK);
+    num_overrides = 0;
+    player_phase = 0;
+    level_1 = 32;
+    level_2 = 24;
+    frame.draw_bitmap(8,3,bmp_wifi_l,16,9,CYAN);
+    add_override(bmp_wifi_s,4,0,8,8,CYAN);
+    push_frame();
+    frame_dirty = true;
+}
+
+/**
+ * Check if writing the audience display blocks interrupts. Display 2 is bit-banged
+ * regardless, but at 128 pixels (~4ms) it is short enough for the WiFi stack.
+ * @return true if WiFi can't run alongside the displays
+ **/
+bool Graphics::output_blocking(){
+    return output_1.blocking();
 }
 
+/**
+ * @return time until the displays next need work (ms), 0 if now, or UINT32_MAX if they are 
+ *  showing static content
+ **/
+uint32_t Graphics::time_to_next(){
+    if(frame_dirty || bar_dirty || overlay_dirty || show_brightness != overlay_shown) return 0;
+    if(output_1.busy() || output_2.busy()) return 0;
+    if(text_strip == NULL || !text_scroll) return UINT32_MAX;
+
+    int32_t left = scroll_last_step + scroll_step_time - clock_millis();
+    return left > 0 ? left : 0;
+}
+
+/**
+ * Get number of frames written to the displays
+ * @return frames pushed since boot
+ **/
+uint32_t Graphics::get_frames_pushed(){
+    return frames_pushed;
+}
+
+/**
+ * Get when the last frame started being written to the displays
+ * @return time (us, as clock_micros())
+ **/
+uint32_t Graphics::get_pushed_at(){
+    return pushed_at;
+}
+
+/**
+ * Get when the first frame started being written to the displays, i.e. how long the timer 
+ * took to show something after boot
+ * @return time since boot (us, as micros()), 0 if no frame has been written yet
+ **/
+uint32_t Graphics::get_first_pushed_at(){
+    return first_pushed_at;
+}
+
+/**
+ * Get number of frames skipped because nothing changed
+ * @return frames skipped since boot
+ **/
+uint32_t Graphics::get_frames_skipped(){
+    return frames_skipped;
+}
+
+/**
+ * @return text currently on screen
+ **/
+const String& Graphics::get_text(){
+    return text_string;
+}
+
+/**
+ * Show a progress bar along the bottom of the audience display
+ * @param permille progress (0 - hide the bar)
+ **/
+void Graphics::show_progress(uint16_t permille){
+    uint8_t width = min(permille, (uint16_t)1000) * FRAME_WIDTH / 1000;
+    if(width == progress_width) return;
+    progress_width = width;
+    frame_dirty = true;
+}
+
+#ifdef PROFILE_OVERLAY
+/**
+ * Update the profiler overlay with the latest stage times
+ * @param profiler with a finished report window
+ **/
+void Graphics::set_profile_overlay(Profiler& profiler){
+    for(uint8_t i = 0; i < PROF_STAGES; i++){
+        profile_levels[i] = profiler.get_level(i, FRAME_HEIGHT);
+    }
+    frame_dirty = true;
+}
+#endif
+
 /**
  * Set three or two players
  * @param in (True - Three Players, False - Two Players)
  **/
 void Graphics::set_three_players(bool in){
     three_players = in;
+    bar_dirty = true;
 }
 
 /**
@@ -155,6 +293,7 @@ void Graphics::set_three_players(bool in){
  **/
 void Graphics::set_red_ready(bool in){
     red_ready = in;
+    bar_dirty = true;
 }
 
 /**
@@ -163,6 +302,7 @@ void Graphics::set_red_ready(bool in){
  **/
 void Graphics::set_blue_ready(bool in){
     blue_ready = in;
+    bar_dirty = true;
 }
 
 /**
@@ -171,6 +311,7 @@ void Graphics::set_blue_ready(bool in){
  **/
 void Graphics::set_green_ready(bool in){
     green_ready = in;
+    bar_dirty = true;
 }
 
 /**
@@ -178,6 +319,7 @@ void Graphics::set_green_ready(bool in){
  **/
 void Graphics::set_show_player_bar(){
     show_player_bar = true;
+    bar_dirty = true;
 }
 
 /**
@@ -186,6 +328,7 @@ void Graphics::set_show_player_bar(){
  **/
 void Graphics::set_show_aux_lights(bool in){
     show_aux_lights = in;
+    bar_dirty = true;
 }
 
 /**
@@ -194,6 +337,7 @@ void Graphics::set_show_aux_lights(bool in){
  **/
 void Graphics::set_show_dim_lights(bool in){
     show_dim_lights = in;
+    bar_dirty = true;
 }
 
 /**
@@ -202,6 +346,7 @@ void Graphics::set_show_dim_lights(bool in){
  **/
 void Graphics::set_rumble_mode(bool in){
     rumble_mode = in;
+    bar_dirty = true;
 }
 
 /**
@@ -209,28 +354,22 @@ void Graphics::set_rumble_mode(bool in){
  **/
 void Graphics::draw_three_players_ready() {
     if(green_ready){
-        display_1.drawRect(8,0,16,2,GREEN);
-        display_2.drawLine(4,0,11,0,GREEN);
+        bar_layer.draw_rect(8,0,16,2,GREEN);
     }else if(show_dim_lights){
-        display_1.drawRect(8,0,16,2,GREEN_DIM);
-        display_2.drawLine(4,0,11,0,GREEN_DIM);
+        bar_layer.draw_rect(8,0,16,2,GREEN_DIM);
     } 
     
     if(show_aux_lights){
         if(blue_ready){
-            display_1.drawRect(0,0,6,2,BLUE);
-            display_2.drawLine(13,0,15,0,BLUE);
+            bar_layer.draw_rect(0,0,6,2,BLUE);
         }else if(show_dim_lights){
-            display_1.drawRect(0,0,6,2,BLUE_DIM);
-            display_2.drawLine(13,0,15,0,BLUE_DIM);
+            bar_layer.draw_rect(0,0,6,2,BLUE_DIM);
         }
 
         if(red_ready){
-            display_1.drawRect(26,0,6,2,RED);
-            display_2.drawLine(0,0,2,0,RED);
+            bar_layer.draw_rect(26,0,6,2,RED);
         }else if(show_dim_lights){
-            display_1.drawRect(26,0,6,2,RED_DIM);
-            display_2.drawLine(0,0,2,0,RED_DIM);
+            bar_layer.draw_rect(26,0,6,2,RED_DIM);
         }
     }
 }
@@ -240,19 +379,15 @@ void Graphics::draw_three_players_ready() {
  **/
 void Graphics::draw_two_players_ready() {
     if(blue_ready){
-        display_1.drawRect(0,0,14,2,BLUE);
-        display_2.drawLine(9,0,15,0,BLUE);
+        bar_layer.draw_rect(0,0,14,2,BLUE);
     }else if(show_dim_lights){
-        display_1.drawRect(0,0,14,2,BLUE_DIM);
-        display_2.drawLine(9,0,15,0,BLUE_DIM);
+        bar_layer.draw_rect(0,0,14,2,BLUE_DIM);
     }
     
     if(red_ready){
-        display_1.drawRect(18,0,14,2,RED);
-        display_2.drawLine(0,0,6,0,RED);
+        bar_layer.draw_rect(18,0,14,2,RED);
     }else if(show_dim_lights){
-        display_1.drawRect(18,0,14,2,RED_DIM);
-        display_2.drawLine(0,0,6,0,RED_DIM);
+        bar_layer.draw_rect(18,0,14,2,RED_DIM);
     }
 }
 
@@ -276,80 +411,182 @@ void Graphics::draw_players_ready(){
 }
 
 /**
- * Draw text
+ * Update the text layer: advance scrolling text
  **/
-void Graphics::draw_text(){
-    if(text_scroll){
+void Graphics::update_text(){
+    if(text_strip == NULL || !text_scroll) return;
+
+    // Advance one pixel for every step of time elapsed, independent of the loop rate
+    uint32_t now = clock_millis();
+    uint8_t steps = 0;
+    while(now - scroll_last_step >= scroll_step_time){
+        // If the loop stalled for a long time, drop the backlog instead of jumping
+        if(++steps > SCROLL_MAX_CATCHUP){
+            scroll_last_step = now;
+            break;
+        }
+        scroll_last_step += scroll_step_time;
         text_xpos--;
+        if(!overlay_shown) frame_dirty = true;
 
         int16_t text_length = text_string.length() * 8;
         if(text_xpos < -text_length){
             text_xpos = 32;
-            isr.trigger();
+            scroll_timer.trigger();
             return;
         }
     }
+}
 
-    display_1.setCursor(text_xpos, 12);
-    display_2.setCursor(text_xpos/2, 6);
+/**
+ * Render the player bar layer (and set the external player lights)
+ **/
+void Graphics::render_bar_layer(){
+    bar_dirty = false;
+    frame_dirty = true;
+    bar_layer.fill(BLACK);
+    if(show_player_bar) draw_players_ready();
+}
 
-    display_1.setFont(&Picopixel);
-    display_2.setFont(&Picopixel);
-    display_1.setTextSize(2);
-    display_2.setTextSize(1);
-    display_1.setTextWrap(false);
-    display_2.setTextWrap(false);
+/**
+ * Render the brightness overlay layer (graphic on left, number on right)
+ **/
+void Graphics::render_overlay_layer(){
+    overlay_dirty = false;
+    frame_dirty = true;
+    memset(overlay_layer, 0, sizeof(overlay_layer));
+
+    // Brightness graphic (16x13 bitmap at 1,2)
+    for(uint8_t y = 0; y < 13; y++){
+        uint16_t row = (pgm_read_byte(&bmp_brightness_l[y * 2]) << 8) | pgm_read_byte(&bmp_brightness_l[y * 2 + 1]);
+        for(uint8_t x = 0; x < 16; x++){
+            if(row & (0x8000 >> x)) overlay_layer[1 + x] |= (1 << (2 + y));
+        }
+    }
 
-    display_1.setTextColor(text_color);
-    display_2.setTextColor(text_color);
-    display_1.print(text_string);
-    display_2.print(text_string);
-    
+    // Brightness number
+    text_cache.rasterize(String(brightness), 0, FRAME_WIDTH - 20, &overlay_layer[20]);
 }
 
 /**
- * Draw brightness display (graphic on left, number on right)
+ * Compose the layers into the frame (background, text, player bars, or the overlay alone)
  **/
-void Graphics::draw_brightness() {
-    display_1.drawBitmap(1,2,bmp_brightness_l,16,13,WHITE);
-    display_2.drawBitmap(0,0,bmp_brightness_s,8,8,WHITE);
+void Graphics::compose(){
+    frame.fill(BLACK);
+    num_overrides = 0;
+    player_phase = 0;
+
+    if(overlay_shown){
+        frame.draw_columns(0, overlay_layer, FRAME_WIDTH, WHITE);
+        add_override(bmp_brightness_s,0,0,8,8,WHITE);
+        return;
+    }
 
-    display_1.setCursor(20, 12);
-    display_2.setCursor(10, 6);
+    if(text_strip != NULL){
+        // Sample the player display in phase with the text so glyphs keep their shape
+        player_phase = text_xpos & 1;
+        if(text_strip->columns != NULL){
+            frame.draw_columns(text_xpos, text_strip->columns, text_strip->width, text_color);
+        }else{
+            // There was no memory to cache the text, so draw the visible columns directly
+            uint16_t window[FRAME_WIDTH] = {};
+            text_cache.rasterize(text_string, -text_xpos, FRAME_WIDTH, window);
+            frame.draw_columns(0, window, FRAME_WIDTH, text_color);
+        }
+    }
+
+    // Bars are drawn over the text
+    for(uint16_t i = 0; i < FRAME_WIDTH * PLAYER_BAR_ROWS; i++){
+        if(bar_layer.pixels[i] != BLACK) frame.pixels[i] = bar_layer.pixels[i];
+    }
 
-    display_1.setFont(&Picopixel);
-    display_2.setFont(&Picopixel);
-    display_1.setTextSize(2);
-    display_2.setTextSize(1);
-    display_1.setTextWrap(false);
-    display_2.setTextWrap(false);
+    if(progress_width > 0) frame.draw_hline(0, FRAME_HEIGHT - 1, progress_width, WHITE);
 
-    display_1.setTextColor(WHITE);
-    display_2.setTextColor(WHITE);
-    display_1.print(String(brightness));
-    display_2.print(String(brightness));
+#ifdef PROFILE_OVERLAY
+    // One bar per stage in the bottom right corner, height is log2 of the mean time in us
+    for(uint8_t i = 0; i < PROF_STAGES; i++){
+        uint8_t level = profile_levels[i];
+        if(level) frame.draw_vline(FRAME_WIDTH - PROF_STAGES + i, FRAME_HEIGHT - level, level, MAGENTA);
+    }
+#endif
 }
 
 /**
- * Update screen brightness
+ * Use a hand-tuned bitmap on the player display instead of the downsampled asset
+ * @param bitmap PROGMEM bitmap
+ * @param x on player display
+ * @param y on player display
+ * @param width of bitmap
+ * @param height of bitmap
+ * @param color of bitmap
  **/
-void Graphics::update_brightness(){
-    display_1.setBrightness(brightness * 10 + 10);
-    display_2.setBrightness(brightness * 10);
+void Graphics::add_override(const uint8_t* bitmap, int16_t x, int16_t y, uint8_t width, 
+        uint8_t height, uint16_t color){
+    if(num_overrides >= MAX_OVERRIDES) return;
+    overrides[num_overrides++] = {bitmap, x, y, width, height, color};
+}
+
+/**
+ * Write the frame to both displays
+ **/
+void Graphics::push_frame(){
+#ifdef SIMULATE
+    // Headless: frames are composed but never sent
+    return;
+#endif
+    PROFILE_START(PROF_GFX_STRIP);
+    downsample();
+    for(uint8_t i = 0; i < num_overrides; i++){
+        Asset_Override& o = overrides[i];
+        player_frame.fill_rect(o.x, o.y, o.width, o.height, BLACK);
+        player_frame.draw_bitmap(o.x, o.y, o.bitmap, o.width, o.height, o.color);
+    }
+
+    frame.write_strip(display_1_map, display_1.getPixels(), level_1);
+    player_frame.write_strip(display_2_map, display_2.getPixels(), level_2);
+    PROFILE_END(PROF_GFX_STRIP);
+
+    // Display 2 is bit-banged with interrupts off, so it goes before display 1 starts on UART1
+    LED_Output* const outputs[] = {&output_1, &output_2};
+    PROFILE_START(PROF_GFX_SHOW);
+    led_output_show(outputs, 2);
+    PROFILE_END(PROF_GFX_SHOW);
 }
 
 /**
- * Parse color from string
- * @param input color with first char capitalized from ["Blue","White","Green","Cyan","Magenta",
- *                                                      "Yellow","Red"]
- * @return Color from [BLUE,WHITE,GREEN,CYAN,MAGENTA,YELLOW,RED] (Default RED)
+ * Derive the player display from the frame with a 2:1 max downsample (per color channel).
+ * The player bar band is mirrored.
  **/
-uint16_t Graphics::parse_color(String input){
-    if(input == "Blue") return BLUE;
-    if(input == "White") return WHITE;
-    if(input == "Green") return GREEN;
-    if(input == "Cyan") return CYAN;
-    if(input == "Magenta") return MAGENTA;
-    if(input == "Yellow") return YELLOW;
-    return RED;
-}
\ No newline at end of file
+void Graphics::downsample(){
+    uint16_t* pixels = frame.pixels;
+
+    for(int16_t y = 0; y < PLAYER_HEIGHT; y++){
+        bool bar_band = (y * 2 < PLAYER_BAR_ROWS);
+        uint8_t phase = bar_band ? 0 : player_phase;
+        uint16_t* row = &pixels[y * 2 * FRAME_WIDTH];
+
+        for(int16_t x = 0; x < PLAYER_WIDTH; x++){
+            uint16_t r = 0, g = 0, b = 0;
+            for(uint8_t i = 0; i < 4; i++){
+                int16_t sx = x * 2 + phase + (i & 1);
+                if(sx >= FRAME_WIDTH) continue;
+                uint16_t c = row[(i >> 1) * FRAME_WIDTH + sx];
+                if((c & 0xF800) > r) r = c & 0xF800;
+                if((c & 0x07E0) > g) g = c & 0x07E0;
+                if((c & 0x001F) > b) b = c & 0x001F;
+            }
+            int16_t dx = bar_band ? PLAYER_WIDTH - 1 - x : x;
+            player_frame.pixels[y * PLAYER_WIDTH + dx] = r | g | b;
+        }
+    }
+}
+
+/**
+ * Update screen brightness
+ **/
+void Graphics::update_brightness(){
+    level_1 = brightness * 10 + 10;
+    level_2 = brightness * 10;
+    overlay_dirty = true;
+    frame_dirty = true;
+}
@@ -6,14 +6,17 @@
  **/
 #include "Arduino.h"
 
-#include "Soft_ISR.h"
+#include "Scheduler.h"
+#include "LED_Output.h"
 
 // Graphics Libraries 
-#include "Adafruit_GFX.h"
+#include "gfxfont.h"
 #include "Adafruit_NeoPixel.h"
-#include "Adafruit_NeoMatrix.h"
+#include "Matrix_Canvas.h"
 #include "Picopixel.h"
 #include "bitmaps.h"
+#include "text_cache.h"
+#include "profile.h"
 
 // Pin Definitions
 #define PIN_DISPLAY1    2
@@ -34,20 +37,69 @@
 #define YELLOW      0xFFE0 
 #define WHITE       0xFFFF
 
+// Color Palette (text colors are given as an index into the palette)
+#define COLOR_BLUE      0
+#define COLOR_RED       1
+#define COLOR_GREEN     2
+#define COLOR_CYAN      3
+#define COLOR_MAGENTA   4
+#define COLOR_YELLOW    5
+#define COLOR_WHITE     6
+
+const uint16_t palette[] = {BLUE, RED, GREEN, CYAN, MAGENTA, YELLOW, WHITE};
+
+// Default text scroll speed (pixels per second)
+#define SCROLL_SPEED        50
+// Maximum pixels to catch up on in a single frame after the loop stalls
+#define SCROLL_MAX_CATCHUP  32
+
+// Frame sizes. The player display is derived from the audience frame at half resolution.
+#define FRAME_WIDTH         32
+#define FRAME_HEIGHT        16
+#define PLAYER_WIDTH        16
+#define PLAYER_HEIGHT       8
+// Matrix layouts. These sums were passed to Adafruit_NeoMatrix as its uint8_t matrix type,
+// where NEO_GRB carries into the layout bits. The pixel maps are built from the same
+// truncated value so the pixel order matches the installed panels.
+#define DISPLAY1_LAYOUT     (uint8_t)(NEO_MATRIX_TOP + NEO_MATRIX_RIGHT + NEO_MATRIX_ROWS + \
+                                NEO_MATRIX_ZIGZAG + NEO_GRB + NEO_KHZ800)
+#define DISPLAY2_LAYOUT     (uint8_t)(NEO_MATRIX_BOTTOM + NEO_MATRIX_LEFT + NEO_MATRIX_COLUMNS + \
+                                NEO_MATRIX_ZIGZAG + NEO_TILE_RIGHT + NEO_GRB + NEO_KHZ800)
+// Top rows of the frame that hold the player ready bars. The players face the display from
+// the other side, so this band is mirrored on the player display.
+#define PLAYER_BAR_ROWS     2
+// Maximum hand-tuned player display bitmaps per frame
+#define MAX_OVERRIDES       2
+
 typedef void (*void_function_pointer)();
 
+// Hand-tuned player display version of an asset, drawn over the downsampled frame
+struct Asset_Override{
+    const uint8_t* bitmap;
+    int16_t x;
+    int16_t y;
+    uint8_t width;
+    uint8_t height;
+    uint16_t color;
+};
+
 class Graphics{
     public:
         void begin();
         void handle();
 
-        void text_static(String,String);
-        void text_dynamic(String,String);
-        void text_dynamic(String,String,void_function_pointer);
+        void text_static(String,uint8_t);
+        void text_dynamic(String,uint8_t);
+        void text_dynamic(String,uint8_t,void_function_pointer);
+        void prewarm_text(String);
+
+        void set_scroll_speed(uint8_t);
 
         void set_brightness(String);
         uint8_t change_brightness();
+        uint8_t get_brightness();
         void show_wifi();
+        void show_progress(uint16_t);
 
         void set_red_ready(bool);
         void set_blue_ready(bool);
@@ -58,21 +110,75 @@ class Graphics{
         void set_show_aux_lights(bool);
         void set_show_dim_lights(bool);
         void set_rumble_mode(bool);
+
+        bool output_blocking();
+        uint32_t time_to_next();
+        uint32_t get_frames_pushed();
+        uint32_t get_frames_skipped();
+        uint32_t get_pushed_at();
+        uint32_t get_first_pushed_at();
+        const String& get_text();
+
+#ifdef PROFILE_OVERLAY
+        void set_profile_overlay(Profiler&);
+#endif
     
     private:
-        // Matrix Displays
-        Adafruit_NeoMatrix display_1 = Adafruit_NeoMatrix(16, 16, 2, 1, PIN_DISPLAY1, 
-            NEO_MATRIX_TOP + NEO_MATRIX_RIGHT + NEO_MATRIX_ROWS + NEO_MATRIX_ZIGZAG + NEO_GRB + NEO_KHZ800);
-        Adafruit_NeoMatrix display_2 = Adafruit_NeoMatrix(8, 8, 2, 1, PIN_DISPLAY2, 
-            NEO_MATRIX_BOTTOM + NEO_MATRIX_LEFT + NEO_MATRIX_COLUMNS + NEO_MATRIX_ZIGZAG + NEO_TILE_RIGHT + NEO_GRB + NEO_KHZ800);
+        // Matrix Displays (pixel buffers are filled through the pixel maps in graphics.cpp)
+        Adafruit_NeoPixel display_1 = Adafruit_NeoPixel(FRAME_WIDTH * FRAME_HEIGHT, PIN_DISPLAY1, 
+            NEO_GRB + NEO_KHZ800);
+        Adafruit_NeoPixel display_2 = Adafruit_NeoPixel(PLAYER_WIDTH * PLAYER_HEIGHT, PIN_DISPLAY2, 
+            NEO_GRB + NEO_KHZ800);
+
+        // Output backends. Display 1 is on GPIO2 (UART1 TX) and can be sent in the background,
+        // define DISPLAY1_BITBANG to use the blocking NeoPixel driver instead. Display 2 is on
+        // GPIO10 which has no UART, so it is always bit-banged.
+#ifdef DISPLAY1_BITBANG
+        LED_Output_Bitbang output_1 = LED_Output_Bitbang(display_1);
+#else
+        LED_Output_UART output_1 = LED_Output_UART(display_1);
+#endif
+        LED_Output_Bitbang output_2 = LED_Output_Bitbang(display_2);
+
+        // Audience frame, composed from the layers below
+        Matrix_Canvas<FRAME_WIDTH, FRAME_HEIGHT> frame;
+        Matrix_Canvas<PLAYER_WIDTH, PLAYER_HEIGHT> player_frame;
+        Asset_Override overrides[MAX_OVERRIDES];
+        uint8_t num_overrides = 0;
+        uint8_t player_phase = 0;
 
         uint8_t brightness;
+        uint8_t level_1;
+        uint8_t level_2;
+
+        // Layers. Each is only re-rendered when its inputs change, and the frame is only
+        // recomposed and written to the displays when a layer has changed.
+        Matrix_Canvas<FRAME_WIDTH, PLAYER_BAR_ROWS> bar_layer;
+        uint16_t overlay_layer[FRAME_WIDTH];
+        bool bar_dirty = true;
+        bool overlay_dirty = false;
+        bool overlay_shown = false;
+        bool frame_dirty = true;
+        uint8_t progress_width = 0;     // Progress bar along the bottom row (0 - hidden)
+
+        uint32_t frames_pushed = 0;
+        uint32_t pushed_at = 0;
+        uint32_t first_pushed_at = 0;
+        uint32_t frames_skipped = 0;
+
+#ifdef PROFILE_OVERLAY
+        uint8_t profile_levels[PROF_STAGES] = {};
+#endif
 
         // Current text on screen
         int16_t text_xpos = 0;
         bool text_scroll = false;
         uint16_t text_color = 0;
         String text_string = "";
+        Text_Cache text_cache = Text_Cache(&Picopixel);
+        const Text_Strip* text_strip = NULL;
+        uint16_t scroll_step_time = 1000 / SCROLL_SPEED;
+        uint32_t scroll_last_step = 0;
 
         // Current graphics on screen
         bool show_player_bar;
@@ -87,11 +193,16 @@ class Graphics{
         void draw_players_ready();
         void draw_two_players_ready();
         void draw_three_players_ready();
-        void draw_text();
-        void draw_brightness();
+        void update_text();
+        void render_bar_layer();
+        void render_overlay_layer();
+        void compose();
+
+        void add_override(const uint8_t*,int16_t,int16_t,uint8_t,uint8_t,uint16_t);
+        void push_frame();
+        void downsample();
 
         void update_brightness();
-        uint16_t parse_color(String);
 };
 
 
@@ -0,0 +1,153 @@
+/**
+ * Idle Mode for Battlebricks Timer
+ * Gives the CPU back between deadlines instead of spinning the loop. While timers are 
+ * pending (or WiFi is on) the loop waits in delay(), capped so buttons are still polled 
+ * often. With WiFi off and nothing scheduled, the chip goes into light sleep until a button 
+ * wakes it.
+ * 
+ * Built with -D SIMULATE, idle() is what moves virtual time forward (see lib/Clock).
+ **/
+#include "idle.h"
+#include "Clock.h"
+
+extern "C" {
+#include "user_interface.h"
+#include "gpio.h"
+}
+
+const uint8_t* idle_wake_pins;
+uint8_t idle_num_pins = 0;
+idle_function idle_before_sleep;
+idle_function idle_after_wake;
+
+uint32_t idle_last = 0;             // Time spent idle by the last call, as seen by micros() (us)
+uint32_t idle_window_start = 0;     // Start of the current window (us)
+uint32_t idle_window_micros = 0;    // Idle time in this window, as seen by micros() (us)
+uint64_t idle_window_real = 0;      // Idle time in this window, including sleep (us)
+uint32_t idle_ratio = 0;            // Idle time in the last window (per mille)
+
+uint32_t idle_sleeps = 0;
+volatile uint32_t idle_wake_time = 0;
+uint32_t idle_max_wake_latency = 0;
+
+/**
+ * Set the button pins that wake the chip from light sleep
+ * @param wake_pins GPIO numbers (buttons to GND)
+ * @param num_pins number of pins
+ * @param before_sleep void function to call before sleeping (release pin interrupts, since 
+ *  the wake-up takes over the pins' interrupt setting)
+ * @param after_wake void function to call after waking
+ **/
+void idle_begin(const uint8_t* wake_pins, uint8_t num_pins, idle_function before_sleep, 
+        idle_function after_wake){
+    idle_wake_pins = wake_pins;
+    idle_num_pins = num_pins;
+    idle_before_sleep = before_sleep;
+    idle_after_wake = after_wake;
+    idle_window_start = micros();
+}
+
+/**
+ * Wake from light sleep
+ **/
+void idle_wake(){
+    idle_wake_time = micros();
+}
+
+/**
+ * Light sleep until a button is pressed (WiFi must be off)
+ * @return time slept (us), measured with the RTC since the CPU clock stops
+ **/
+uint32_t idle_sleep(){
+    uint32_t rtc_start = system_get_rtc_time();
+    idle_before_sleep();
+
+    wifi_set_opmode_current(NULL_MODE);
+    wifi_fpm_set_sleep_type(LIGHT_SLEEP_T);
+    wifi_fpm_open();
+    for(uint8_t i = 0; i < idle_num_pins; i++){
+        gpio_pin_wakeup_enable(GPIO_ID_PIN(idle_wake_pins[i]), GPIO_PIN_INTR_LOLEVEL);
+    }
+    wifi_fpm_set_wakeup_cb(idle_wake);
+    wifi_fpm_do_sleep(0xFFFFFFF);
+    // Sleep starts once the loop yields, and the loop continues here after waking
+    delay(1);
+
+    uint32_t latency = micros() - idle_wake_time;
+    if(latency > idle_max_wake_latency) idle_max_wake_latency = latency;
+    idle_sleeps++;
+
+    gpio_pin_wakeup_disable();
+    wifi_fpm_close();
+    idle_after_wake();
+
+    uint32_t rtc_cycles = system_get_rtc_time() - rtc_start;
+    return ((uint64_t)rtc_cycles * system_rtc_clock_cali_proc()) >> 12;
+}
+
+/**
+ * Wait for the next deadline, or sleep if there is none (run at the end of each loop)
+ * @param time_to_next time until something needs the loop (ms, UINT32_MAX if nothing)
+ * @param allow_sleep light sleep is allowed (WiFi off)
+ **/
+void idle(uint32_t time_to_next, bool allow_sleep){
+#ifdef SIMULATE
+    (void)allow_sleep;
+    // Virtual time only moves here, by as long as the device would have waited (at least 1ms,
+    // as the loop itself takes no time)
+    clock_delay(constrain(time_to_next, (uint32_t)1, (uint32_t)IDLE_MAX_DELAY));
+#else
+    // Idle ratio over the last window, counting sleep at its real length
+    uint32_t window = micros() - idle_window_start;
+    if(window >= IDLE_WINDOW){
+        uint64_t total = (uint64_t)(window - idle_window_micros) + idle_window_real;
+        idle_ratio = idle_window_real * 1000 / total;
+        idle_window_start = micros();
+        idle_window_micros = 0;
+        idle_window_real = 0;
+    }
+
+    idle_last = 0;
+    if(time_to_next < IDLE_MIN_TIME) return;
+
+    uint32_t start = micros();
+    uint32_t real;
+    if(time_to_next == UINT32_MAX && allow_sleep && idle_num_pins > 0){
+        real = idle_sleep();
+    }else{
+        delay(min(time_to_next, (uint32_t)IDLE_MAX_DELAY));
+        real = micros() - start;
+    }
+    idle_last = micros() - start;
+    idle_window_micros += idle_last;
+    idle_window_real += real;
+#endif
+}
+
+/**
+ * @return time spent idle in the last full window (per mille)
+ **/
+uint32_t idle_get_ratio(){
+    return idle_ratio;
+}
+
+/**
+ * @return time the last idle() call took, as seen by micros() (us)
+ **/
+uint32_t idle_get_last(){
+    return idle_last;
+}
+
+/**
+ * @return number of light sleeps since boot
+ **/
+uint32_t idle_get_sleeps(){
+    return idle_sleeps;
+}
+
+/**
+ * @return most time from a button waking the chip to the loop running again (us)
+ **/
+uint32_t idle_get_max_wake_latency(){
+    return idle_max_wake_latency;
+}
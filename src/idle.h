@@ -0,0 +1,30 @@
+/**
+ * Idle Mode for Battlebricks Timer
+ * Gives the CPU back between deadlines instead of spinning the loop. While timers are 
+ * pending (or WiFi is on) the loop waits in delay(), capped so buttons are still polled 
+ * often. With WiFi off and nothing scheduled, the chip goes into light sleep until a button 
+ * wakes it.
+ * 
+ * Built with -D SIMULATE, idle() is what moves virtual time forward (see lib/Clock).
+ * 
+ * Run idle() at the end of each loop.
+ **/
+#include "Arduino.h"
+
+// Don't bother idling for less than this (ms)
+#define IDLE_MIN_TIME       2
+// Longest wait while awake, so buttons are still polled well within the debounce time (ms)
+#define IDLE_MAX_DELAY      10
+// Time over which the idle ratio is measured (us)
+#define IDLE_WINDOW         10000000
+
+typedef void (*idle_function)();
+
+void idle_begin(const uint8_t* wake_pins, uint8_t num_pins, idle_function before_sleep, 
+    idle_function after_wake);
+void idle(uint32_t time_to_next, bool allow_sleep);
+
+uint32_t idle_get_ratio();
+uint32_t idle_get_last();
+uint32_t idle_get_sleeps();
+uint32_t idle_get_max_wake_latency();
@@ -0,0 +1,120 @@
+/**
+ * Match Journal for Battlebricks Timer
+ * Keeps the last JOURNAL_SIZE match events in a fixed RAM ring, and serves them at 
+ * /journal.csv and /journal.json.
+ **/
+#include "journal.h"
+#include "states.h"
+#include "Web_Interface.h"
+
+const char* const journal_type_names[JOURNAL_TYPES] = {
+    "boot", "press", "ready", "unready", "rumble", "start", "go", 
+    "pause", "resume", "game_over", "reset", "time", "mode", "brightness", "recover"
+};
+const char* const journal_player_names[JOURNAL_PLAYERS] = {"", "black", "blue", "red", "green"};
+// Same order as the states in states.h
+const char* const journal_state_names[NUM_STATES] = {
+    "startup", "standby", "pre", "countdown", "paused", "game_over"
+};
+
+// Marks a ring that was written before a restart rather than left over from power-up
+#define JOURNAL_MAGIC 0x424A524E
+
+// Not cleared at boot, so the events before a restart can still be read in WiFi setup mode
+#ifdef SIMULATE
+Journal_Ring journal;
+#else
+Journal_Ring journal __attribute__((section(".noinit")));
+#endif
+
+/**
+ * Add an event to the journal, overwriting the oldest if it's full
+ * @param type of event
+ * @param player whose button or setting it was (Journal_Player)
+ * @param state of the timer after the event
+ * @param remaining match time (ms)
+ * @param time of the event (ms, as clock_millis())
+ **/
+void journal_record(Journal_Type type, uint8_t player, uint8_t state, uint32_t remaining, 
+    uint32_t time){
+    Journal_Entry& entry = journal.entries[journal.count % JOURNAL_SIZE];
+    entry.time = time;
+    entry.remaining = remaining;
+    entry.type = type;
+    entry.player = player;
+    entry.state = state;
+    journal.count++;
+}
+
+/**
+ * Get the sequence number of the oldest event still in the journal
+ * @return sequence number
+ **/
+uint32_t journal_first(){
+    return journal.count > JOURNAL_SIZE ? journal.count - JOURNAL_SIZE : 0;
+}
+
+/**
+ * Get the name of a state
+ * @param state of the timer
+ * @return name
+ **/
+const char* journal_state_name(uint8_t state){
+    return state < NUM_STATES ? journal_state_names[state] : "";
+}
+
+/**
+ * Print the journal as CSV, oldest first
+ * @param out to print to
+ **/
+void journal_csv(Print& out){
+    out.print("seq,time_ms,event,player,state,remaining_ms\n");
+    for(uint32_t seq = journal_first(); seq < journal.count; seq++){
+        const Journal_Entry& entry = journal.entries[seq % JOURNAL_SIZE];
+        out.printf("%u,%u,%s,%s,%s,%u\n", seq, entry.time, journal_type_names[entry.type], 
+            journal_player_names[entry.player], journal_state_name(entry.state), entry.remaining);
+    }
+}
+
+/**
+ * Print the journal as a JSON array, oldest first
+ * @param out to print to
+ **/
+void journal_json(Print& out){
+    out.print("[");
+    for(uint32_t seq = journal_first(); seq < journal.count; seq++){
+        const Journal_Entry& entry = journal.entries[seq % JOURNAL_SIZE];
+        if(seq != journal_first()) out.print(",");
+        out.printf("{\"seq\":%u,\"time_ms\":%u,\"event\":\"%s\",\"player\":\"%s\",", seq, 
+            entry.time, journal_type_names[entry.type], journal_player_names[entry.player]);
+        out.printf("\"state\":\"%s\",\"remaining_ms\":%u}", journal_state_name(entry.state), 
+            entry.remaining);
+    }
+    out.print("]");
+}
+
+/**
+ * Check that the ring survived a restart: after power-up it holds whatever the RAM came up 
+ * with, and the names of every entry are looked up by index
+ * @return true if it can be kept
+ **/
+bool journal_valid(){
+    if(journal.magic != JOURNAL_MAGIC) return false;
+    for(const Journal_Entry& entry : journal.entries){
+        if(entry.type >= JOURNAL_TYPES || entry.player >= JOURNAL_PLAYERS) return false;
+    }
+    return true;
+}
+
+/**
+ * Keep the events from before a restart if they're intact, and serve the journal pages
+ * @param webinterface to serve from
+ **/
+void journal_begin(Web_Interface& webinterface){
+    if(!journal_valid()){
+        memset(&journal, 0, sizeof(journal));
+        journal.magic = JOURNAL_MAGIC;
+    }
+    webinterface.add_page("/journal.csv", "text/csv", journal_csv);
+    webinterface.add_page("/journal.json", "application/json", journal_json);
+}
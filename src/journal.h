@@ -0,0 +1,64 @@
+/**
+ * Match Journal for Battlebricks Timer
+ * Keeps the last JOURNAL_SIZE match events (presses, ready, pause, resume, reset, setting 
+ * changes...) in a fixed RAM ring, and serves them at /journal.csv and /journal.json.
+ * 
+ * Recording an event copies 12 bytes into the ring, so it can stay on during play.
+ * 
+ * The ring isn't cleared at boot, so a restart (software, watchdog or reset pin) keeps it and
+ * it can be read in WiFi setup mode, which is only entered by restarting. Sequence numbers carry on, but times 
+ * start again from 0 after each boot event. Turning the power off loses it, since the ESP8266
+ * has no room to keep it anywhere else (RTC memory is 512 bytes).
+ **/
+#include "Arduino.h"
+
+// Number of events kept (oldest are overwritten)
+#define JOURNAL_SIZE 128
+
+class Web_Interface;
+
+typedef enum {
+    JOURNAL_BOOT        = 0,
+    JOURNAL_PRESS       = 1,    // Button went down (time is the first edge)
+    JOURNAL_READY       = 2,
+    JOURNAL_UNREADY     = 3,
+    JOURNAL_RUMBLE      = 4,
+    JOURNAL_START       = 5,    // All players ready, match time set
+    JOURNAL_GO          = 6,
+    JOURNAL_PAUSE       = 7,
+    JOURNAL_RESUME      = 8,
+    JOURNAL_GAME_OVER   = 9,
+    JOURNAL_RESET       = 10,
+    JOURNAL_TIME        = 11,   // Total time changed
+    JOURNAL_MODE        = 12,   // Number of players changed
+    JOURNAL_BRIGHTNESS  = 13,
+    JOURNAL_RECOVER     = 14,   // Booted back into a match after a reset
+    JOURNAL_TYPES       = 15
+} Journal_Type;
+
+typedef enum {
+    JOURNAL_NONE    = 0,
+    JOURNAL_BLACK   = 1,
+    JOURNAL_BLUE    = 2,
+    JOURNAL_RED     = 3,
+    JOURNAL_GREEN   = 4,
+    JOURNAL_PLAYERS = 5
+} Journal_Player;
+
+struct Journal_Entry{
+    uint32_t time;          // When it happened (ms, as clock_millis())
+    uint32_t remaining;     // Match time remaining (ms)
+    uint8_t type;           // Journal_Type
+    uint8_t player;         // Journal_Player
+    uint8_t state;          // Timer state after the event
+};
+
+struct Journal_Ring{
+    uint32_t magic;         // Set once the ring has been cleared
+    uint32_t count;         // Events recorded, the next one goes in entries[count % JOURNAL_SIZE]
+    Journal_Entry entries[JOURNAL_SIZE];
+};
+
+void journal_begin(Web_Interface& webinterface);
+void journal_record(Journal_Type type, uint8_t player, uint8_t state, uint32_t remaining, 
+    uint32_t time);
@@ -0,0 +1,83 @@
+/**
+ * Match Clock for Battlebricks Timer
+ * Keeps the match time as an absolute end deadline while running and as milliseconds 
+ * remaining while stopped, so the time shown is derived from the clock and loop delays never
+ * add up.
+ **/
+#include "match_clock.h"
+
+/**
+ * Stop the clock and set the time remaining
+ * @param time remaining (ms)
+ **/
+void Match_Clock::set(uint32_t time){
+    _running = false;
+    _remaining = time;
+}
+
+/**
+ * Start or resume counting down
+ **/
+void Match_Clock::start(){
+    if(_running) return;
+    _running = true;
+    _started = clock_millis();
+    _end = _started + _remaining;
+}
+
+/**
+ * Stop counting down, keeping the exact time remaining
+ **/
+void Match_Clock::pause(){
+    if(!_running) return;
+    _remaining = remaining();
+    _running = false;
+}
+
+/**
+ * @return true if counting down
+ **/
+bool Match_Clock::running(){
+    return _running;
+}
+
+/**
+ * @return time remaining (ms)
+ **/
+uint32_t Match_Clock::remaining(){
+    if(!_running) return _remaining;
+    int32_t left = _end - clock_millis();
+    return left > 0 ? left : 0;
+}
+
+/**
+ * @return time remaining rounded up to whole seconds, as shown on the clock
+ **/
+uint16_t Match_Clock::seconds(){
+    return (remaining() + 999) / 1000;
+}
+
+/**
+ * @return true during the first half of each second (when the colon is shown)
+ **/
+bool Match_Clock::colon(){
+    return (remaining() + 999) % 1000 >= MATCH_TICK_TIME;
+}
+
+/**
+ * @return when the clock was last started (ms, as clock_millis())
+ **/
+uint32_t Match_Clock::started_at(){
+    return _started;
+}
+
+/**
+ * @return when the display next changes, on a half second of the time remaining 
+ *  (ms, as clock_millis())
+ **/
+uint32_t Match_Clock::next_tick(){
+    uint32_t left = remaining();
+    if(left == 0) return _end;
+    uint32_t next_left = ((left - 1) / MATCH_TICK_TIME) * MATCH_TICK_TIME;
+    return _end - next_left;
+}
@@ -0,0 +1,31 @@
+/**
+ * Match Clock for Battlebricks Timer
+ * Keeps the match time as an absolute end deadline while running and as milliseconds 
+ * remaining while stopped, so the time shown is derived from the clock and loop delays never
+ * add up.
+ **/
+#include "Arduino.h"
+#include "Clock.h"
+
+// The display changes every half second (colon on for the first half of each second)
+#define MATCH_TICK_TIME 500
+
+class Match_Clock{
+    public:
+        void set(uint32_t time);
+        void start();
+        void pause();
+
+        bool running();
+        uint32_t remaining();
+        uint16_t seconds();
+        bool colon();
+        uint32_t started_at();
+        uint32_t next_tick();
+
+    private:
+        bool _running = false;
+        uint32_t _remaining = 0;    // Time remaining while stopped (ms)
+        uint32_t _end = 0;          // Deadline while running (ms, as clock_millis())
+        uint32_t _started = 0;      // When the clock was last started (ms, as clock_millis())
+};
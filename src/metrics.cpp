@@ -0,0 +1,199 @@
+/**
+ * Runtime Metrics for Battlebricks Timer
+ * Serves heap, flash, loop, timer and display health at /metrics (Prometheus text format) and
+ * /metrics.json.
+ **/
+#include "metrics.h"
+#include "graphics.h"
+#include "config.h"
+#include "Web_Interface.h"
+#include "Persistent_Storage.h"
+#include "idle.h"
+#include "Buzzer.h"
+
+Graphics* metrics_graphics;
+Buzzer* metrics_buzzer = NULL;
+Config* metrics_config;
+
+// Loop health
+uint32_t loop_last = 0;             // Start of the last loop (us)
+uint32_t loop_worst = 0;            // Longest time between loop starts since boot (us)
+uint32_t loop_count = 0;            // Loops in the current second
+uint32_t loop_rate = 0;             // Loops in the last full second
+uint32_t loop_window_start = 0;     // Start of the current second (ms)
+
+// Audio/visual sync of the 3-2-1-GO steps (time from buzzer start to display push)
+bool av_armed = false;
+uint32_t av_armed_at = 0;           // When the step ran (us)
+uint32_t av_last = 0;               // Offset of the last step (us)
+uint32_t av_worst = 0;              // Largest offset since boot (us)
+
+/**
+ * Print one Prometheus metric
+ * @param out to print to
+ * @param name of metric
+ * @param type of metric (gauge or counter)
+ * @param help description
+ * @param value of metric
+ **/
+void print_metric(Print& out, const char* name, const char* type, const char* help, uint32_t value){
+    out.printf("# HELP battlebricks_%s %s\n", name, help);
+    out.printf("# TYPE battlebricks_%s %s\n", name, type);
+    out.printf("battlebricks_%s %u\n", name, value);
+}
+
+/**
+ * Print all metrics in Prometheus text format
+ * @param out to print to
+ **/
+void metrics_prometheus(Print& out){
+    FSInfo fs_info;
+    storage.info(fs_info);
+
+    print_metric(out, "uptime_ms", "counter", "Time since boot", millis());
+    print_metric(out, "boot_display_us", "gauge", "Time from boot to the first frame", 
+        metrics_graphics->get_first_pushed_at());
+    print_metric(out, "heap_free_bytes", "gauge", "Free heap", ESP.getFreeHeap());
+    print_metric(out, "heap_max_block_bytes", "gauge", "Largest free heap block", 
+        ESP.getMaxFreeBlockSize());
+    print_metric(out, "heap_fragmentation_percent", "gauge", "Heap fragmentation", 
+        ESP.getHeapFragmentation());
+    print_metric(out, "loop_rate_hz", "gauge", "Loop iterations in the last second", loop_rate);
+    print_metric(out, "loop_worst_us", "gauge", "Longest loop iteration since boot", loop_worst);
+    print_metric(out, "storage_writes_total", "counter", "Persistent storage file writes", 
+        Persistent_Storage::get_writes());
+    print_metric(out, "storage_written_bytes_total", "counter", "Persistent storage bytes written", 
+        Persistent_Storage::get_bytes_written());
+    print_metric(out, "storage_sets_total", "counter", "Persistent storage changes", 
+        Persistent_Storage::get_sets());
+    print_metric(out, "storage_set_bytes_total", "counter", "Persistent storage bytes changed", 
+        Persistent_Storage::get_bytes_set());
+    print_metric(out, "storage_commit_us", "gauge", "Time taken by the last storage write", 
+        Persistent_Storage::get_commit_time());
+    print_metric(out, "storage_commit_max_us", "gauge", "Longest storage write since boot", 
+        Persistent_Storage::get_max_commit_time());
+    print_metric(out, "storage_recoveries_total", "counter", 
+        "Storage files restored after an interrupted write", Persistent_Storage::get_recoveries());
+    print_metric(out, "fs_used_bytes", "gauge", "File system used", fs_info.usedBytes);
+    print_metric(out, "fs_total_bytes", "gauge", "File system size", fs_info.totalBytes);
+    print_metric(out, "config_age_ms", "gauge", "Time since settings were loaded", 
+        millis() - metrics_config->loaded_at);
+    print_metric(out, "config_load_us", "gauge", "Time taken to load settings", 
+        metrics_config->load_time);
+    print_metric(out, "frames_pushed_total", "counter", "Frames written to the displays", 
+        metrics_graphics->get_frames_pushed());
+    print_metric(out, "frames_skipped_total", "counter", "Frames skipped as unchanged", 
+        metrics_graphics->get_frames_skipped());
+    print_metric(out, "idle_ratio_permille", "gauge", "Time spent idle or asleep", 
+        idle_get_ratio());
+    print_metric(out, "sleeps_total", "counter", "Light sleeps", idle_get_sleeps());
+    print_metric(out, "wake_latency_max_us", "gauge", "Most time from button wake to loop", 
+        idle_get_max_wake_latency());
+    print_metric(out, "timers_fired_total", "counter", "Timers seen expiring by the interrupt", 
+        scheduler.get_fired());
+    print_metric(out, "timer_jitter_max_ms", "gauge", "Most time from deadline to interrupt", 
+        scheduler.get_max_jitter());
+    print_metric(out, "timer_latency_max_us", "gauge", "Most time from interrupt to callback", 
+        scheduler.get_max_latency());
+    print_metric(out, "timer_latency_mean_us", "gauge", "Mean time from interrupt to callback", 
+        scheduler.get_mean_latency());
+    print_metric(out, "av_offset_last_us", "gauge", 
+        "Time from buzzer to display at the last countdown step", av_last);
+    print_metric(out, "av_offset_max_us", "gauge", 
+        "Most time from buzzer to display at a countdown step", av_worst);
+}
+
+/**
+ * Print all metrics as a JSON object
+ * @param out to print to
+ **/
+void metrics_json(Print& out){
+    FSInfo fs_info;
+    storage.info(fs_info);
+
+    out.printf("{\"uptime_ms\":%u,", millis());
+    out.printf("\"boot_display_us\":%u,", metrics_graphics->get_first_pushed_at());
+    out.printf("\"heap_free_bytes\":%u,", ESP.getFreeHeap());
+    out.printf("\"heap_max_block_bytes\":%u,", ESP.getMaxFreeBlockSize());
+    out.printf("\"heap_fragmentation_percent\":%u,", ESP.getHeapFragmentation());
+    out.printf("\"loop_rate_hz\":%u,", loop_rate);
+    out.printf("\"loop_worst_us\":%u,", loop_worst);
+    out.printf("\"storage_writes\":%u,", Persistent_Storage::get_writes());
+    out.printf("\"storage_written_bytes\":%u,", Persistent_Storage::get_bytes_written());
+    out.printf("\"storage_sets\":%u,", Persistent_Storage::get_sets());
+    out.printf("\"storage_set_bytes\":%u,", Persistent_Storage::get_bytes_set());
+    out.printf("\"storage_commit_us\":%u,", Persistent_Storage::get_commit_time());
+    out.printf("\"storage_commit_max_us\":%u,", Persistent_Storage::get_max_commit_time());
+    out.printf("\"storage_recoveries\":%u,", Persistent_Storage::get_recoveries());
+    out.printf("\"fs_used_bytes\":%u,", (unsigned)fs_info.usedBytes);
+    out.printf("\"fs_total_bytes\":%u,", (unsigned)fs_info.totalBytes);
+    out.printf("\"config_age_ms\":%u,", millis() - metrics_config->loaded_at);
+    out.printf("\"config_load_us\":%u,", metrics_config->load_time);
+    out.printf("\"frames_pushed\":%u,", metrics_graphics->get_frames_pushed());
+    out.printf("\"frames_skipped\":%u,", metrics_graphics->get_frames_skipped());
+    out.printf("\"idle_ratio_permille\":%u,", idle_get_ratio());
+    out.printf("\"sleeps\":%u,", idle_get_sleeps());
+    out.printf("\"wake_latency_max_us\":%u,", idle_get_max_wake_latency());
+    out.printf("\"timers_fired\":%u,", scheduler.get_fired());
+    out.printf("\"timer_jitter_max_ms\":%u,", scheduler.get_max_jitter());
+    out.printf("\"timer_latency_max_us\":%u,", scheduler.get_max_latency());
+    out.printf("\"timer_latency_mean_us\":%u,", scheduler.get_mean_latency());
+    out.printf("\"av_offset_last_us\":%u,", av_last);
+    out.printf("\"av_offset_max_us\":%u}", av_worst);
+}
+
+/**
+ * Serve the metrics pages
+ * @param webinterface to serve from
+ * @param graphics to report frame counts of
+ * @param buzzer to check the display against
+ * @param config to report load time of
+ **/
+void metrics_begin(Web_Interface& webinterface, Graphics& graphics, Buzzer& buzzer, 
+    Config& config){
+    metrics_graphics = &graphics;
+    metrics_buzzer = &buzzer;
+    metrics_config = &config;
+
+    webinterface.add_page("/metrics", "text/plain; version=0.0.4", metrics_prometheus);
+    webinterface.add_page("/metrics.json", "application/json", metrics_json);
+
+    loop_last = micros();
+    loop_window_start = millis();
+}
+
+/**
+ * Track loop rate and latency (run at the start of each loop)
+ **/
+void metrics_loop(){
+    uint32_t now = micros();
+    // Time given back in idle() isn't loop latency
+    uint32_t elapsed = now - loop_last - idle_get_last();
+    loop_last = now;
+    if(elapsed > loop_worst) loop_worst = elapsed;
+
+    // The frame for a step is pushed later in the same loop, so it's checked on the next one
+    if(av_armed && (int32_t)(metrics_graphics->get_pushed_at() - av_armed_at) >= 0){
+        av_armed = false;
+        av_last = metrics_graphics->get_pushed_at() - metrics_buzzer->get_started_at();
+        if(av_last > av_worst) av_worst = av_last;
+    }
+
+    loop_count++;
+    if(millis() - loop_window_start >= 1000){
+        loop_window_start = millis();
+        loop_rate = loop_count;
+        loop_count = 0;
+    }
+}
+
+/**
+ * Measure the offset between the buzzer and the display for the step that just started
+ * (run right after starting its sound and text)
+ **/
+void metrics_av_sync(){
+    // Nothing to measure against with the buzzer off
+    if(metrics_buzzer == NULL || !metrics_buzzer->playing()) return;
+    av_armed = true;
+    av_armed_at = clock_micros();
+}
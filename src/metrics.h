@@ -0,0 +1,18 @@
+/**
+ * Runtime Metrics for Battlebricks Timer
+ * Serves heap, flash, loop, timer and display health at /metrics (Prometheus text format) and
+ * /metrics.json.
+ * 
+ * Run metrics_loop() at the start of each loop.
+ **/
+#include "Arduino.h"
+
+class Web_Interface;
+class Graphics;
+class Buzzer;
+struct Config;
+
+void metrics_begin(Web_Interface& webinterface, Graphics& graphics, Buzzer& buzzer, 
+    Config& config);
+void metrics_loop();
+void metrics_av_sync();
@@ -0,0 +1,19 @@
+/**
+ * Profiler stages
+ * Build with -D PROFILE to time each stage of the main loop (see lib/Profiler). Add 
+ * -D PROFILE_OVERLAY to also draw the mean time of each stage on the main display.
+ **/
+#include "Profiler.h"
+
+enum Profile_Stage{
+    PROF_SCHEDULER,
+    PROF_INPUT,
+    PROF_GFX_TEXT,
+    PROF_GFX_BARS,
+    PROF_GFX_COMPOSE,
+    PROF_GFX_STRIP,
+    PROF_GFX_SHOW,
+    PROF_WEB,
+    PROF_LOOP,
+    PROF_STAGES
+};
@@ -0,0 +1,224 @@
+/**
+ * Match Simulator for Battlebricks Timer
+ * Build with -D SIMULATE to play random matches against the timer sequence in virtual time 
+ * (see lib/Clock), with the displays headless.
+ **/
+#include "simulator.h"
+
+#ifdef SIMULATE
+
+#include "states.h"
+#include "graphics.h"
+#include "config.h"
+#include "Clock.h"
+#include "Button.h"
+#include "Buzzer.h"
+
+// Defined in battlebricks.cpp
+extern uint8_t state;
+extern uint16_t total_time;
+extern uint8_t mode;
+extern Config config;
+extern Graphics graphics;
+extern Buzzer buzzer;
+extern Button btn_black;
+extern Button btn_blue;
+extern Button btn_red;
+extern Button btn_green;
+void reset();
+
+// Ready taps (3 players, one of them changing their mind), then a pause and resume per pause
+#define SIM_MAX_TAPS    (5 + SIM_MAX_PAUSES * 2)
+
+struct Sim_Tap{
+    uint8_t after_state;    // Only tap in this state, once it's been in it for time
+    uint32_t time;          // (ms)
+    Button* button;
+    uint16_t hold;          // (ms, short of a long press)
+};
+
+uint32_t sim_seed;
+
+Sim_Tap sim_taps[SIM_MAX_TAPS];
+uint8_t sim_num_taps;
+uint8_t sim_next_tap;
+Button* sim_held;               // Button pressed by the current tap, if any
+uint32_t sim_pressed_at;        // (ms)
+
+bool sim_verbose;
+uint32_t sim_start;             // (ms)
+uint8_t sim_last_state;
+String sim_last_text;
+uint32_t sim_entered[NUM_STATES];   // When each state was last entered (ms)
+uint32_t sim_counting;          // Time spent counting down (ms)
+uint8_t sim_pauses;
+
+/**
+ * @param low lowest number
+ * @param high one more than the highest number
+ * @return pseudo-random number from the seed (xorshift32), the same for the same seed
+ **/
+uint32_t sim_random(uint32_t low, uint32_t high){
+    sim_seed ^= sim_seed << 13;
+    sim_seed ^= sim_seed >> 17;
+    sim_seed ^= sim_seed << 5;
+    return low + sim_seed % (high - low);
+}
+
+/**
+ * Add a tap to the script
+ * @param after_state only tap in this state
+ * @param time in the state before tapping (ms)
+ * @param button to tap
+ **/
+void sim_add_tap(uint8_t after_state, uint32_t time, Button* button){
+    if(sim_num_taps >= SIM_MAX_TAPS) return;
+    sim_taps[sim_num_taps++] = {after_state, time, button, (uint16_t)sim_random(50, 300)};
+}
+
+/**
+ * Script a random match: the players get ready in a random order, some time apart (one may 
+ * tap twice more, not ready and ready again), then the match is paused up to SIM_MAX_PAUSES
+ * times and resumed after a while (fewer if the match ends first)
+ **/
+void sim_random_script(){
+    sim_num_taps = 0;
+
+    Button* players[] = {&btn_blue, &btn_red, &btn_green};
+    uint8_t num_players = mode == THREE_PLAYER ? 3 : 2;
+    for(uint8_t i = num_players - 1; i > 0; i--){
+        uint8_t j = sim_random(0, i + 1);
+        Button* swap = players[i];
+        players[i] = players[j];
+        players[j] = swap;
+    }
+
+    // Taps in standby are timed from when it started, so each is after the last one's hold
+    uint32_t time = 0;
+    bool changes_mind = sim_random(0, 4) == 0;
+    for(uint8_t i = 0; i < num_players; i++){
+        uint8_t taps = changes_mind && i == 0 ? 3 : 1;
+        for(uint8_t t = 0; t < taps; t++){
+            time += sim_random(400, 2000);
+            sim_add_tap(STANDBY, time, players[i]);
+        }
+    }
+
+    uint8_t pauses = sim_random(0, SIM_MAX_PAUSES + 1);
+    for(uint8_t i = 0; i < pauses; i++){
+        sim_add_tap(COUNTDOWN, sim_random(0, total_time * 1000UL / (pauses + 1)), &btn_black);
+        sim_add_tap(PAUSED, sim_random(300, 10000), &btn_black);
+    }
+}
+
+/**
+ * Follow the match and play the script (the idle callback, so it runs at every ms)
+ **/
+void sim_step(){
+    uint32_t now = clock_millis();
+
+    if(sim_verbose && graphics.get_text() != sim_last_text){
+        sim_last_text = graphics.get_text();
+        Serial.printf("sim_text,%u,%s\n", now - sim_start, sim_last_text.c_str());
+    }
+    if(state != sim_last_state){
+        if(sim_verbose) Serial.printf("sim_state,%u,%u\n", now - sim_start, state);
+        if(sim_last_state == COUNTDOWN) sim_counting += now - sim_entered[COUNTDOWN];
+        if(state == PAUSED) sim_pauses++;
+        sim_last_state = state;
+        sim_entered[state] = now;
+    }
+
+    if(sim_held != NULL){
+        if(now - sim_pressed_at < sim_taps[sim_next_tap - 1].hold) return;
+        sim_held->inject(false);
+        sim_held = NULL;
+    }
+    if(sim_next_tap >= sim_num_taps) return;
+    const Sim_Tap& tap = sim_taps[sim_next_tap];
+    if(state != tap.after_state || now - sim_entered[state] < tap.time) return;
+
+    tap.button->inject(true);
+    sim_held = tap.button;
+    sim_pressed_at = now;
+    sim_next_tap++;
+}
+
+/**
+ * Play the scripted match from standby to game over
+ * @param verbose print every state and text change
+ * @return time the match spent counting down (ms), or 0 if game over was never reached
+ **/
+uint32_t sim_match(bool verbose){
+    btn_black.inject(false);
+    btn_blue.inject(false);
+    btn_red.inject(false);
+    btn_green.inject(false);
+    reset();
+
+    sim_verbose = verbose;
+    sim_start = clock_millis();
+    sim_next_tap = 0;
+    sim_held = NULL;
+    sim_last_state = state;
+    sim_last_text = "";
+    sim_entered[state] = sim_start;
+    sim_counting = 0;
+    sim_pauses = 0;
+
+    while(clock_millis() - sim_start < SIM_TIMEOUT){
+        sim_step();
+        loop();
+        sim_step();
+        if(sim_last_state == GAME_OVER) return sim_counting;
+
+        // The next loop is late
+        if(sim_random(0, SIM_STALL_CHANCE) == 0) clock_advance(sim_random(1, SIM_MAX_STALL + 1));
+    }
+    return 0;
+}
+
+/**
+ * Play random matches and print the results
+ * @param seed for the matches (the same seed plays the same matches)
+ * @param matches to play
+ * @return number of matches that didn't reach game over, or counted down for longer or 
+ *  shorter than the match time
+ **/
+uint16_t run_simulation(uint32_t seed, uint16_t matches){
+    // xorshift never leaves 0
+    sim_seed = seed ^ 0x5EED5EED;
+    if(sim_seed == 0) sim_seed = 1;
+
+    config.buzzer_on = false;
+    buzzer.set_buzzer_on(false);
+    graphics.set_rumble_mode(false);
+    clock_set_idle_callback(sim_step);
+
+    uint16_t failures = 0;
+    for(uint16_t i = 0; i < matches; i++){
+        mode = sim_random(0, 2);
+        graphics.set_three_players(mode == THREE_PLAYER);
+        total_time = sim_random(10, 301);
+        config.pre_time = sim_random(0, 6);
+        config.go_time = sim_random(0, 4);
+        config.game_over_time = sim_random(0, 4);
+        config.show_ready = sim_random(0, 2);
+        sim_random_script();
+
+        uint32_t measured = sim_match(i == 0);
+        int32_t expected = total_time * 1000;
+        int32_t deviation = (int32_t)measured - expected;
+        if(measured == 0 || deviation < 0 || deviation > SIM_TOLERANCE) failures++;
+        Serial.printf("sim,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%d,%d\n", seed, i, mode, total_time, 
+            config.pre_time, config.go_time, config.game_over_time, config.show_ready, 
+            sim_pauses, measured, expected, deviation);
+    }
+
+    if(sim_held != NULL) sim_held->inject(false);
+    clock_set_idle_callback(NULL);
+    Serial.printf("sim,done,%u\n", failures);
+    return failures;
+}
+
+#endif
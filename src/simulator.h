@@ -0,0 +1,30 @@
+/**
+ * Match Simulator for Battlebricks Timer
+ * Build with -D SIMULATE (as [env:native] does) to play random matches against the timer 
+ * sequence in virtual time (see lib/Clock), with the displays headless. Each match gets 
+ * random settings, players getting ready in a random order, up to SIM_MAX_PAUSES pauses at 
+ * random times, and loops that randomly stall (like a blocking show()). The same seed always
+ * plays the same matches.
+ * 
+ * Every state and text change of the first match is printed over Serial, followed by one 
+ * line per match with the total time spent counting down, which should equal the match time
+ * however the match was paused:
+ *  "sim,<seed>,<match>,<mode>,<total_time>,<pre_time>,<go_time>,<game_over_time>,
+ *  <show_ready>,<pauses>,<measured_ms>,<expected_ms>,<deviation_ms>"
+ * 
+ * Run it after setup(), e.g. from test/test_simulator.
+ **/
+#include "Arduino.h"
+
+// Chance of a loop stalling (1 in SIM_STALL_CHANCE), and the longest stall (ms)
+#define SIM_STALL_CHANCE    50
+#define SIM_MAX_STALL       30
+// Most pauses in one match
+#define SIM_MAX_PAUSES      3
+// Counting time allowed to differ from the match time (ms): the end of the match is only 
+// seen by the loop after it, which can be a stall late
+#define SIM_TOLERANCE       SIM_MAX_STALL
+// Give up on a match if it doesn't reach game over within this time of starting (ms)
+#define SIM_TIMEOUT         900000
+
+uint16_t run_simulation(uint32_t seed, uint16_t matches);
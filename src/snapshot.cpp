@@ -0,0 +1,51 @@
+/**
+ * Match Snapshot for Battlebricks Timer
+ * Keeps the match state in RTC user memory, so the timer can pick up a match after a reset.
+ **/
+#include "snapshot.h"
+#include "coredecls.h"
+#include "user_interface.h"
+
+// Marks memory written by this firmware ("BBTS")
+#define SNAPSHOT_MAGIC 0x42425453
+
+/**
+ * Read the snapshot left before the last reset. Only crashes resume a match: a restart from 
+ * the web interface, wifi setup or the reset button starts fresh.
+ * @param snapshot to fill
+ * @return true if there was a valid snapshot and the reset wasn't deliberate
+ **/
+bool snapshot_load(Snapshot& snapshot){
+#ifdef SIMULATE
+    (void)snapshot;
+    return false;
+#else
+    // Brown-outs are reported as power-on resets, which the CRC catches if the memory was lost
+    uint32_t reason = ESP.getResetInfoPtr()->reason;
+    if(reason != REASON_DEFAULT_RST && reason != REASON_WDT_RST && 
+        reason != REASON_EXCEPTION_RST && reason != REASON_SOFT_WDT_RST){
+        return false;
+    }
+
+    if(!ESP.rtcUserMemoryRead(SNAPSHOT_RTC_OFFSET, (uint32_t*)&snapshot, sizeof(Snapshot))){
+        return false;
+    }
+    if(snapshot.magic != SNAPSHOT_MAGIC) return false;
+    return snapshot.crc == crc32(&snapshot, offsetof(Snapshot, crc));
+#endif
+}
+
+/**
+ * Write a snapshot (takes a few microseconds)
+ * @param snapshot to write, its magic and CRC are filled in
+ **/
+void snapshot_save(Snapshot& snapshot){
+#ifdef SIMULATE
+    (void)snapshot;
+#else
+    snapshot.magic = SNAPSHOT_MAGIC;
+    snapshot.reserved = 0;
+    snapshot.crc = crc32(&snapshot, offsetof(Snapshot, crc));
+    ESP.rtcUserMemoryWrite(SNAPSHOT_RTC_OFFSET, (uint32_t*)&snapshot, sizeof(Snapshot));
+#endif
+}
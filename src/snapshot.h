@@ -0,0 +1,29 @@
+/**
+ * Match Snapshot for Battlebricks Timer
+ * Keeps the match state in RTC user memory, which survives a watchdog, exception or 
+ * brown-out reset (but not a power cycle), so the timer can pick up a match where it was.
+ * A CRC guards against the memory being garbage after power-up. Deliberate restarts (software
+ * restart, reset button, deep sleep) never resume.
+ * 
+ * Does nothing when built with -D SIMULATE.
+ **/
+#include "Arduino.h"
+
+// Position in RTC user memory (4 byte blocks), clear of the 128 bytes used by OTA updates
+#define SNAPSHOT_RTC_OFFSET 64
+
+struct Snapshot{
+    uint32_t magic;
+    uint32_t remaining;     // Match time remaining (ms)
+    uint16_t total_time;    // Match length (s)
+    uint8_t state;
+    uint8_t mode;
+    uint8_t ready;          // Ready flags (bit 0 red, bit 1 blue, bit 2 green)
+    uint8_t brightness;
+    uint8_t color_timer;
+    uint8_t reserved;
+    uint32_t crc;
+};
+
+bool snapshot_load(Snapshot& snapshot);
+void snapshot_save(Snapshot& snapshot);
@@ -0,0 +1,32 @@
+/**
+ * Sound Definitions for Battlebricks Timer
+ * Buzzer patterns of {tone (Hz, 0 for a plain beep), on time (ms), gap (ms), repeats}, each 
+ * ending with an empty step. Play one with buzzer.play(sounds[SOUND_...]).
+ **/
+#include "Buzzer.h"
+
+const PROGMEM Buzzer_Step snd_short[] = {   {0, 100, 0, 1}, {0, 0, 0, 0}};
+
+const PROGMEM Buzzer_Step snd_ready[] = {   {0, 100, 100, 2}, {0, 0, 0, 0}};
+
+const PROGMEM Buzzer_Step snd_tick[] = {    {0, 250, 0, 1}, {0, 0, 0, 0}};
+
+const PROGMEM Buzzer_Step snd_boot[] = {    {0, 500, 0, 1}, {0, 0, 0, 0}};
+
+const PROGMEM Buzzer_Step snd_long[] = {    {0, 1000, 0, 1}, {0, 0, 0, 0}};
+
+const PROGMEM Buzzer_Step snd_game_over[] = {{0, 2000, 0, 1}, {0, 0, 0, 0}};
+
+enum Sound_ID{
+    SOUND_SHORT,        // Button acknowledged
+    SOUND_READY,        // Player ready / not ready
+    SOUND_TICK,         // 3-2-1 and restarts
+    SOUND_BOOT,
+    SOUND_LONG,         // Pause, cancel and GO (without a GO time)
+    SOUND_GAME_OVER,    // Game over (without a game over time)
+    SOUNDS
+};
+
+const Buzzer_Step* const sounds[SOUNDS] = {
+    snd_short, snd_ready, snd_tick, snd_boot, snd_long, snd_game_over
+};
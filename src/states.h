@@ -0,0 +1,19 @@
+/**
+ * States for Battlebricks Timer
+ * States of the timer sequence and game modes, shared by the sketch, the journal and the 
+ * match simulator.
+ **/
+
+// States
+#define STARTUP     0
+#define STANDBY     1
+#define PRE         2
+#define COUNTDOWN   3
+#define PAUSED      4
+#define GAME_OVER   5
+#define NUM_STATES  6
+
+// Modes
+#define TWO_PLAYER      0
+#define THREE_PLAYER    1
+#define RUMBLE          2
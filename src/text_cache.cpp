@@ -0,0 +1,165 @@
+/**
+ * Text Strip Cache for Battlebricks Timer
+ * Renders each message once into a packed column bitmap, so drawing text only has to
+ * copy a window of columns into the frame.
+ **/
+#include "text_cache.h"
+
+/**
+ * Constructor
+ * @param font to render with (GFX font in PROGMEM)
+ **/
+Text_Cache::Text_Cache(const GFXfont* font){
+    _font = font;
+}
+
+/**
+ * Get the rendered strip for a message, rendering it if it isn't cached
+ * @param text message
+ * @return rendered strip (valid until TEXT_CACHE_SIZE other messages are rendered)
+ **/
+const Text_Strip* Text_Cache::get(const String& text){
+    Text_Strip* strip = find(text);
+    if(strip == NULL) strip = render(text);
+    return strip;
+}
+
+/**
+ * Get the rendered strip for static text. Text that isn't cached is rendered into a buffer 
+ * kept aside for it, so text that changes every second doesn't allocate or push messages out
+ * of the cache.
+ * @param text message
+ * @return rendered strip (valid until the next call)
+ **/
+const Text_Strip* Text_Cache::get_static(const String& text){
+    Text_Strip* strip = find(text);
+    if(strip != NULL) return strip;
+
+    uint16_t width = rasterize(text, 0, 0, NULL);
+    if(width > TEXT_SCRATCH_WIDTH) return get(text);
+
+    memset(scratch_columns, 0, sizeof(scratch_columns));
+    rasterize(text, 0, width, scratch_columns);
+    scratch.text = text;
+    scratch.width = width;
+    scratch.columns = scratch_columns;
+    return &scratch;
+}
+
+/**
+ * Render a message ahead of time and keep it in the cache permanently
+ * @param text message
+ **/
+void Text_Cache::prewarm(const String& text){
+    if(text == "") return;
+    Text_Strip* strip = find(text);
+    if(strip == NULL) strip = render(text);
+    // Without memory for the columns there is nothing worth keeping
+    strip->pinned = strip->columns != NULL;
+}
+
+/**
+ * Keep a strip from being replaced while it is on screen
+ * @param strip to keep
+ **/
+void Text_Cache::hold(const Text_Strip* strip){
+    held = strip;
+}
+
+/**
+ * Find a cached message
+ * @param text message
+ * @return strip, or NULL if not cached
+ **/
+Text_Strip* Text_Cache::find(const String& text){
+    for(uint8_t i = 0; i < TEXT_CACHE_SIZE; i++){
+        if(strips[i].columns != NULL && strips[i].text == text) return &strips[i];
+    }
+    return NULL;
+}
+
+/**
+ * Render a message into the next free (or oldest unpinned) slot
+ * @param text message
+ * @return rendered strip
+ **/
+Text_Strip* Text_Cache::render(const String& text){
+    // Find the next slot that isn't pinned or held
+    Text_Strip* strip = &strips[next_slot];
+    for(uint8_t i = 0; i < TEXT_CACHE_SIZE && (strip->pinned || strip == held); i++){
+        next_slot = (next_slot + 1) % TEXT_CACHE_SIZE;
+        strip = &strips[next_slot];
+    }
+    next_slot = (next_slot + 1) % TEXT_CACHE_SIZE;
+
+    free(strip->columns);
+
+    strip->text = text;
+    strip->pinned = false;
+    strip->width = rasterize(text, 0, 0, NULL);
+    strip->columns = (uint16_t*)calloc(strip->width + 1, sizeof(uint16_t));
+
+    // Without memory the strip only has a width, and is drawn with rasterize() instead
+    if(strip->columns != NULL) rasterize(text, 0, strip->width, strip->columns);
+
+    return strip;
+}
+
+/**
+ * Draw columns of a message into a column bitmap, the same way Adafruit GFX prints a custom 
+ * font. Also measures the message, so the width always matches what is drawn.
+ * @param text message
+ * @param start first column of the message to draw
+ * @param width of the column bitmap
+ * @param columns 16-row column bitmap, or NULL to only measure
+ * @return width of the whole message (columns)
+ **/
+uint16_t Text_Cache::rasterize(const String& text, int16_t start, uint16_t width, 
+    uint16_t* columns){
+    uint8_t first = pgm_read_byte(&_font->first);
+    uint8_t last = pgm_read_byte(&_font->last);
+    GFXglyph* glyphs = (GFXglyph*)pgm_read_ptr(&_font->glyph);
+    uint8_t* bitmap = (uint8_t*)pgm_read_ptr(&_font->bitmap);
+
+    int16_t cursor = 0;
+    int16_t extent = 0;
+    for(uint16_t i = 0; i < text.length(); i++){
+        uint8_t c = text[i];
+        if(c < first || c > last) continue;
+        GFXglyph glyph;
+        memcpy_P(&glyph, &glyphs[c - first], sizeof(GFXglyph));
+
+        // A glyph can reach past its advance, so the message ends at whichever is further
+        int16_t right = cursor + (glyph.xOffset + glyph.width) * TEXT_SIZE;
+        if(right > extent) extent = right;
+
+        if(columns != NULL){
+            // Glyph bits are packed row by row, MSB first
+            uint16_t offset = glyph.bitmapOffset;
+            uint8_t bits = 0;
+            uint8_t bit = 0;
+            for(uint8_t yy = 0; yy < glyph.height; yy++){
+                for(uint8_t xx = 0; xx < glyph.width; xx++){
+                    if(!(bit++ & 7)) bits = pgm_read_byte(&bitmap[offset++]);
+                    bool on = bits & 0x80;
+                    bits <<= 1;
+                    if(!on) continue;
+
+                    for(uint8_t sx = 0; sx < TEXT_SIZE; sx++){
+                        int16_t x = cursor + (glyph.xOffset + xx) * TEXT_SIZE + sx - start;
+                        if(x < 0 || x >= width) continue;
+                        for(uint8_t sy = 0; sy < TEXT_SIZE; sy++){
+                            int16_t y = TEXT_BASELINE + (glyph.yOffset + yy) * TEXT_SIZE + sy;
+                            if(y < 0 || y >= 16) continue;
+                            columns[x] |= (1 << y);
+                        }
+                    }
+                }
+            }
+        }
+
+        cursor += glyph.xAdvance * TEXT_SIZE;
+        if(cursor > extent) extent = cursor;
+    }
+    return extent;
+}
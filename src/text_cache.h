@@ -0,0 +1,49 @@
+/**
+ * Text Strip Cache for Battlebricks Timer
+ * Renders each message once into a packed column bitmap, so drawing text only has to
+ * copy a window of columns into the frame.
+ **/
+#include "Arduino.h"
+#include "gfxfont.h"
+
+// Number of messages kept rendered
+#define TEXT_CACHE_SIZE     8
+
+// Text baseline and size on the audience display
+#define TEXT_BASELINE       12
+#define TEXT_SIZE           2
+// Columns kept aside for static text (like the countdown), which changes too often to cache
+#define TEXT_SCRATCH_WIDTH  64
+
+struct Text_Strip{
+    String text;
+    bool pinned = false;
+
+    // 16 rows, bit y = row y (NULL if there was no memory for them)
+    uint16_t* columns = NULL;
+    uint16_t width = 0;
+};
+
+class Text_Cache{
+    public:
+        Text_Cache(const GFXfont* font);
+
+        const Text_Strip* get(const String& text);
+        const Text_Strip* get_static(const String& text);
+        void prewarm(const String& text);
+        void hold(const Text_Strip* strip);
+        uint16_t rasterize(const String& text, int16_t start, uint16_t width, 
+            uint16_t* columns);
+
+    private:
+        const GFXfont* _font;
+        Text_Strip strips[TEXT_CACHE_SIZE];
+        uint8_t next_slot = 0;
+        const Text_Strip* held = NULL;
+
+        Text_Strip scratch;
+        uint16_t scratch_columns[TEXT_SCRATCH_WIDTH];
+
+        Text_Strip* find(const String& text);
+        Text_Strip* render(const String& text);
+};
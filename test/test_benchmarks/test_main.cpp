@@ -0,0 +1,85 @@
+/**
+ * Host Benchmarks for Battlebricks Timer
+ * Times the paths that only need the CPU, on the host ([env:native]). Results are printed in
+ * the same CSV format as the on-device benchmarks (see src/benchmark.h), so run with
+ * "pio test -e native -f test_benchmarks -v" to see them. Host times are only comparable to
+ * each other, not to the device.
+ **/
+#include <unity.h>
+#include "Arduino.h"
+#include "Native.h"
+#include "benchmark.h"
+#include "Web_Interface.h"
+#include "Persistent_Storage.h"
+#include "config.h"
+
+// Defined in battlebricks.cpp
+extern Web_Interface webinterface;
+String format_time(uint16_t time, bool colon);
+
+Persistent_Storage* bench_storage;
+
+// Every setting load_config() reads, as the timer read them one at a time before it
+const char* config_ids[] = {
+    "msg_intro", "msg_rumble", "msg_get_ready", "msg_game_over", "color_intro", "color_pre",
+    "color_timer", "show_aux_lights", "show_dim_lights", "show_ready", "buzzer_on", "min_time",
+    "max_time", "interval_time", "pre_time", "go_time", "game_over_time", "scroll_speed",
+    "auto_reset", "hotspot_SSID", "hotspot_password", "wifi_during_play"
+};
+Config bench_config;
+
+void setUp(){}
+void tearDown(){}
+
+void test_format_time(){
+    benchmark("format_time", 1000, [](uint16_t i){ format_time(i % 600, i & 1); });
+    TEST_ASSERT_TRUE(format_time(185, true) == "3:05");
+    TEST_ASSERT_TRUE(format_time(185, false) == "3 05");
+}
+
+void test_load_setting(){
+    benchmark("load_setting", 100, [](uint16_t){ webinterface.load_setting("scroll_speed"); });
+    TEST_ASSERT_FALSE(webinterface.load_setting("scroll_speed") == "");
+}
+
+void test_load_config(){
+    benchmark("load_setting_each", 20, [](uint16_t){
+        for(const char* id : config_ids) webinterface.load_setting(id);
+    });
+    benchmark("load_config", 20, [](uint16_t){ load_config(bench_config, webinterface); });
+    TEST_ASSERT_TRUE(bench_config.hotspot_ssid == webinterface.load_setting("hotspot_SSID"));
+    TEST_ASSERT_EQUAL(webinterface.load_setting("scroll_speed").toInt(), bench_config.scroll_speed);
+    TEST_ASSERT_EQUAL(webinterface.load_setting("show_ready") == "true", bench_config.show_ready);
+}
+
+void test_settings_html(){
+    benchmark("settings_html", 100, [](uint16_t){ webinterface.settings_html(); });
+    TEST_ASSERT_TRUE(webinterface.settings_html().indexOf("scroll_speed") >= 0);
+}
+
+void test_storage_set(){
+    benchmark("storage_set", 1000, [](uint16_t i){ bench_storage->set("key", String(i)); });
+    TEST_ASSERT_TRUE(bench_storage->get("key") == "999");
+}
+
+void test_storage_get(){
+    benchmark("storage_get", 1000, [](uint16_t){ bench_storage->get("key"); });
+}
+
+int main(){
+    native_fs_load("data");
+    // Copies the default settings into place
+    webinterface.begin();
+    // Stays linked into the list that flush_all() writes, so it's never deleted
+    bench_storage = new Persistent_Storage("bench");
+
+    UNITY_BEGIN();
+    benchmark_header();
+    RUN_TEST(test_format_time);
+    RUN_TEST(test_load_setting);
+    RUN_TEST(test_load_config);
+    RUN_TEST(test_settings_html);
+    RUN_TEST(test_storage_set);
+    RUN_TEST(test_storage_get);
+    return UNITY_END();
+}
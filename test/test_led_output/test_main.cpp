@@ -0,0 +1,225 @@
+/**
+ * LED Output Tests
+ * Checks the UART encoding of WS2812 data against the WS2812B timing, by rebuilding the line
+ * levels UART1 would send (start bit, 6 data bits LSB first, stop bit, all inverted) and 
+ * splitting them into 1.25us bit cells. Also checks that bit-banging the player display can't
+ * starve the UART1 FIFO of the audience display part way through a frame.
+ **/
+#include <unity.h>
+#include "Arduino.h"
+#include "Native.h"
+#include "LED_Output.h"
+
+// Length of one UART bit on the line (ps)
+#define UART_BIT_TIME   (1000000000000ULL / WS2812_UART_BAUD)
+// UART bits per WS2812 bit, and per UART byte (6N1)
+#define CELL_BITS       4
+#define FRAME_BITS      8
+
+// WS2812B datasheet timing (ns)
+#define T0H             400
+#define T1H             800
+#define T0L             850
+#define T1L             450
+#define T_TOLERANCE     150
+
+void setUp(){}
+void tearDown(){}
+
+/**
+ * @param time (ps)
+ * @param spec (ns)
+ * @return true if time is within the datasheet tolerance of spec
+ **/
+bool within(uint64_t time, uint32_t spec){
+    return time + T_TOLERANCE * 1000ULL >= spec * 1000ULL && 
+        time <= (spec + T_TOLERANCE) * 1000ULL;
+}
+
+/**
+ * Decode the WS2812 bits in a UART byte, failing the test if either cell is out of spec
+ * @param uart_byte as written to the FIFO
+ * @return the two WS2812 bits, first one in bit 1
+ **/
+uint8_t decode(uint8_t uart_byte){
+    bool levels[FRAME_BITS];
+    levels[0] = true;
+    for(uint8_t i = 0; i < 6; i++) levels[i + 1] = !((uart_byte >> i) & 1);
+    levels[7] = false;
+
+    uint8_t bits = 0;
+    for(uint8_t cell = 0; cell < FRAME_BITS / CELL_BITS; cell++){
+        const bool* level = &levels[cell * CELL_BITS];
+        uint8_t high = 0;
+        while(high < CELL_BITS && level[high]) high++;
+        for(uint8_t i = high; i < CELL_BITS; i++){
+            TEST_ASSERT_FALSE_MESSAGE(level[i], "cell goes high again after going low");
+        }
+
+        uint64_t high_time = high * UART_BIT_TIME;
+        uint64_t low_time = (CELL_BITS - high) * UART_BIT_TIME;
+        bool zero = within(high_time, T0H) && within(low_time, T0L);
+        bool one = within(high_time, T1H) && within(low_time, T1L);
+        TEST_ASSERT_TRUE_MESSAGE(zero != one, "cell is not a valid WS2812 bit");
+        bits = bits << 1 | one;
+    }
+    return bits;
+}
+
+/**
+ * Decode the 4 UART bytes ws2812_uart_encode() makes from a pixel byte
+ * @param uart_bytes to decode
+ * @return pixel byte
+ **/
+uint8_t decode_byte(const uint8_t* uart_bytes){
+    uint8_t value = 0;
+    for(uint8_t i = 0; i < 4; i++) value = value << 2 | decode(uart_bytes[i]);
+    return value;
+}
+
+void test_symbols(){
+    // Every 2-bit symbol, in every position of a byte
+    const struct{
+        uint8_t symbol;
+        uint8_t uart_byte;
+    } table[] = {
+        {0b00, 0b110111},
+        {0b01, 0b000111},
+        {0b10, 0b110100},
+        {0b11, 0b000100}
+    };
+
+    for(auto& row : table){
+        TEST_ASSERT_EQUAL_UINT8(row.symbol, decode(row.uart_byte));
+        for(uint8_t position = 0; position < 4; position++){
+            uint8_t out[4];
+            ws2812_uart_encode(row.symbol << (6 - position * 2), out);
+            for(uint8_t i = 0; i < 4; i++){
+                TEST_ASSERT_EQUAL_HEX8(i == position ? row.uart_byte : table[0].uart_byte, out[i]);
+            }
+        }
+    }
+}
+
+void test_all_bytes(){
+    for(uint16_t value = 0; value < 256; value++){
+        uint8_t out[4];
+        ws2812_uart_encode(value, out);
+        TEST_ASSERT_EQUAL_UINT8(value, decode_byte(out));
+    }
+}
+
+/**
+ * Send a frame through UART1 as the hardware would, refilling the FIFO from the interrupt
+ * @param output to show
+ * @return UART bytes sent
+ **/
+std::vector<uint8_t>& send(LED_Output_UART& output){
+    // Wait out the latch time after the last frame (or boot)
+    while(output.busy()) yield();
+    native_uart_sent(UART1).clear();
+    output.show();
+    while(native_uart_drain(UART1, UART_FIFO_SIZE));
+    return native_uart_sent(UART1);
+}
+
+void test_uart_config(){
+    Adafruit_NeoPixel strip(1, 2, NEO_GRB + NEO_KHZ800);
+    LED_Output_UART output(strip);
+    output.begin();
+
+    TEST_ASSERT_EQUAL_UINT32(WS2812_UART_BAUD, Serial1.baudRate());
+    TEST_ASSERT_EQUAL_UINT8(SERIAL_6N1, Serial1.config());
+    TEST_ASSERT_TRUE(USC0(UART1) & (1 << UCTXI));
+    TEST_ASSERT_EQUAL_UINT32(UART_FIFO_THRESHOLD, (USC1(UART1) >> UCFET) & 0x7F);
+}
+
+void test_grb_pixel(){
+    Adafruit_NeoPixel strip(1, 2, NEO_GRB + NEO_KHZ800);
+    LED_Output_UART output(strip);
+    output.begin();
+    strip.setPixelColor(0, 0x12, 0xA5, 0xF0);
+
+    std::vector<uint8_t>& sent = send(output);
+    TEST_ASSERT_EQUAL_UINT32(3 * 4, sent.size());
+    TEST_ASSERT_EQUAL_HEX8(0xA5, decode_byte(&sent[0]));
+    TEST_ASSERT_EQUAL_HEX8(0x12, decode_byte(&sent[4]));
+    TEST_ASSERT_EQUAL_HEX8(0xF0, decode_byte(&sent[8]));
+    TEST_ASSERT_FALSE(USIE(UART1) & (1 << UIFE));
+}
+
+void test_frame_larger_than_fifo(){
+    // The 32x16 audience display: the interrupt has to refill the FIFO many times
+    Adafruit_NeoPixel strip(512, 2, NEO_GRB + NEO_KHZ800);
+    LED_Output_UART output(strip);
+    output.begin();
+    for(uint16_t i = 0; i < strip.numPixels(); i++) strip.setPixelColor(i, i, i >> 1, ~i);
+
+    std::vector<uint8_t>& sent = send(output);
+    TEST_ASSERT_EQUAL_UINT32(strip.numPixels() * 3 * 4, sent.size());
+    for(uint16_t i = 0; i < strip.numPixels(); i++){
+        TEST_ASSERT_EQUAL_HEX8((uint8_t)(i >> 1), decode_byte(&sent[i * 12]));
+        TEST_ASSERT_EQUAL_HEX8((uint8_t)i, decode_byte(&sent[i * 12 + 4]));
+        TEST_ASSERT_EQUAL_HEX8((uint8_t)~i, decode_byte(&sent[i * 12 + 8]));
+    }
+}
+
+/**
+ * Set up the two displays as Graphics does: the audience display on UART1 and the player
+ * display bit-banged, each filled with a pattern
+ **/
+struct Displays{
+    Adafruit_NeoPixel audience = Adafruit_NeoPixel(512, 2, NEO_GRB + NEO_KHZ800);
+    Adafruit_NeoPixel player = Adafruit_NeoPixel(128, 10, NEO_GRB + NEO_KHZ800);
+    LED_Output_UART output_1 = LED_Output_UART(audience);
+    LED_Output_Bitbang output_2 = LED_Output_Bitbang(player);
+
+    Displays(){
+        output_1.begin();
+        output_2.begin();
+        for(uint16_t i = 0; i < audience.numPixels(); i++) audience.setPixelColor(i, i, ~i, i >> 2);
+        for(uint16_t i = 0; i < player.numPixels(); i++) player.setPixelColor(i, ~i, i, i);
+        while(output_1.busy()) native_uart_drain(UART1, UART_FIFO_SIZE);
+        native_uart_sent(UART1).clear();
+    }
+};
+
+void test_bitbang_starves_uart(){
+    // Sending the player display after starting the UART transfer leaves the FIFO empty
+    Displays displays;
+    uint32_t underruns = native_uart_underruns(UART1);
+    displays.output_1.show();
+    displays.output_2.show();
+    TEST_ASSERT_GREATER_THAN_UINT32(underruns, native_uart_underruns(UART1));
+    while(native_uart_drain(UART1, UART_FIFO_SIZE));
+}
+
+void test_show_both_displays(){
+    Displays displays;
+    LED_Output* const outputs[] = {&displays.output_1, &displays.output_2};
+    uint32_t underruns = native_uart_underruns(UART1);
+    led_output_show(outputs, 2);
+    while(native_uart_drain(UART1, UART_FIFO_SIZE));
+
+    TEST_ASSERT_EQUAL_UINT32(underruns, native_uart_underruns(UART1));
+    TEST_ASSERT_EQUAL_UINT32(1, displays.player.show_count());
+    std::vector<uint8_t>& sent = native_uart_sent(UART1);
+    TEST_ASSERT_EQUAL_UINT32(displays.audience.numPixels() * 3 * 4, sent.size());
+    for(uint16_t i = 0; i < displays.audience.numPixels(); i++){
+        TEST_ASSERT_EQUAL_HEX8((uint8_t)~i, decode_byte(&sent[i * 12]));
+        TEST_ASSERT_EQUAL_HEX8((uint8_t)i, decode_byte(&sent[i * 12 + 4]));
+        TEST_ASSERT_EQUAL_HEX8((uint8_t)(i >> 2), decode_byte(&sent[i * 12 + 8]));
+    }
+}
+
+int main(){
+    UNITY_BEGIN();
+    RUN_TEST(test_symbols);
+    RUN_TEST(test_all_bytes);
+    RUN_TEST(test_uart_config);
+    RUN_TEST(test_grb_pixel);
+    RUN_TEST(test_frame_larger_than_fifo);
+    RUN_TEST(test_bitbang_starves_uart);
+    RUN_TEST(test_show_both_displays);
+    return UNITY_END();
+}
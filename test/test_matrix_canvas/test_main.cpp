@@ -0,0 +1,151 @@
+/**
+ * Matrix Canvas Tests for Battlebricks Timer
+ * Checks that write_strip() puts every pixel where Adafruit_NeoMatrix did, and times it
+ * against the old path on the host: a virtual drawPixel() for each pixel, which remaps it,
+ * gamma corrects it and scales it in setPixelColor(). Results are printed in the CSV format
+ * of src/benchmark.h with -v.
+ *
+ * The old path here keeps the layout a compile-time constant (the library kept it in a
+ * member), so if anything it's faster than what it stands in for.
+ **/
+#include <unity.h>
+#include "Arduino.h"
+#include "Native.h"
+#include "benchmark.h"
+#include "graphics.h"
+
+#include <vector>
+
+constexpr Pixel_Map<FRAME_WIDTH, FRAME_HEIGHT, 16, 16, DISPLAY1_LAYOUT> display_1_map;
+constexpr Pixel_Map<PLAYER_WIDTH, PLAYER_HEIGHT, 8, 8, DISPLAY2_LAYOUT> display_2_map;
+
+#define BRIGHTNESS 42
+
+/**
+ * Drawing surface of the old path, called through Adafruit_GFX
+ **/
+class Old_Display{
+    public:
+        virtual void draw_pixel(int16_t x, int16_t y, uint16_t color) = 0;
+};
+
+/**
+ * Adafruit_NeoMatrix::drawPixel() with the gamma table on and a brightness set
+ **/
+template<class MAP, uint8_t WIDTH, uint8_t HEIGHT>
+class Old_Matrix : public Old_Display{
+    public:
+        Adafruit_NeoPixel strip = Adafruit_NeoPixel(WIDTH * HEIGHT);
+        uint16_t scale = BRIGHTNESS + 1;
+
+        void draw_pixel(int16_t x, int16_t y, uint16_t color) override{
+            if(x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) return;
+            uint16_t index = MAP::remap(x, y);
+            uint8_t r = gamma5[color >> 11];
+            uint8_t g = gamma6[(color >> 5) & 0x3F];
+            uint8_t b = gamma5[color & 0x1F];
+            strip.setPixelColor(index, (r * scale) >> 8, (g * scale) >> 8, (b * scale) >> 8);
+        }
+};
+
+Matrix_Canvas<FRAME_WIDTH, FRAME_HEIGHT> frame;
+Matrix_Canvas<PLAYER_WIDTH, PLAYER_HEIGHT> player_frame;
+Adafruit_NeoPixel display_1(FRAME_WIDTH * FRAME_HEIGHT);
+Adafruit_NeoPixel display_2(PLAYER_WIDTH * PLAYER_HEIGHT);
+Old_Matrix<decltype(display_1_map), FRAME_WIDTH, FRAME_HEIGHT> old_matrix_1;
+Old_Matrix<decltype(display_2_map), PLAYER_WIDTH, PLAYER_HEIGHT> old_matrix_2;
+Old_Display* old_display_1 = &old_matrix_1;
+Old_Display* old_display_2 = &old_matrix_2;
+
+void setUp(){}
+void tearDown(){}
+
+/**
+ * Fill a canvas with every kind of color
+ * @param canvas to fill
+ * @param seed to start the colors from
+ **/
+template<class CANVAS>
+void fill_random(CANVAS& canvas, uint32_t seed){
+    for(uint16_t& pixel : canvas.pixels){
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        pixel = seed;
+    }
+}
+
+/**
+ * Draw a canvas the old way
+ * @param display to draw on
+ * @param canvas to draw
+ * @param width of canvas
+ * @param height of canvas
+ **/
+template<class CANVAS>
+void draw_old(Old_Display* display, const CANVAS& canvas, uint8_t width, uint8_t height){
+    for(int16_t y = 0; y < height; y++){
+        for(int16_t x = 0; x < width; x++){
+            display->draw_pixel(x, y, canvas.pixels[y * width + x]);
+        }
+    }
+}
+
+/**
+ * @param map to check
+ * @param pixels in the map
+ * @return true if every strip index is used once
+ **/
+template<class MAP>
+bool is_permutation(const MAP& map, uint16_t pixels){
+    std::vector<bool> used(pixels);
+    for(uint16_t i = 0; i < pixels; i++){
+        if(map.index[i] >= pixels || used[map.index[i]]) return false;
+        used[map.index[i]] = true;
+    }
+    return true;
+}
+
+void test_maps(){
+    TEST_ASSERT_TRUE(is_permutation(display_1_map, FRAME_WIDTH * FRAME_HEIGHT));
+    TEST_ASSERT_TRUE(is_permutation(display_2_map, PLAYER_WIDTH * PLAYER_HEIGHT));
+}
+
+void test_same_as_old(){
+    for(uint32_t seed = 1; seed <= 8; seed++){
+        fill_random(frame, seed);
+        fill_random(player_frame, seed * 7919);
+        frame.write_strip(display_1_map, display_1.getPixels(), BRIGHTNESS);
+        player_frame.write_strip(display_2_map, display_2.getPixels(), BRIGHTNESS);
+        draw_old(old_display_1, frame, FRAME_WIDTH, FRAME_HEIGHT);
+        draw_old(old_display_2, player_frame, PLAYER_WIDTH, PLAYER_HEIGHT);
+        TEST_ASSERT_EQUAL_MEMORY(old_matrix_1.strip.getPixels(), display_1.getPixels(),
+            FRAME_WIDTH * FRAME_HEIGHT * 3);
+        TEST_ASSERT_EQUAL_MEMORY(old_matrix_2.strip.getPixels(), display_2.getPixels(),
+            PLAYER_WIDTH * PLAYER_HEIGHT * 3);
+    }
+}
+
+void test_write_strip_speed(){
+    fill_random(frame, 1);
+    fill_random(player_frame, 2);
+    benchmark("neomatrix_draw_frame", 1000, [](uint16_t){
+        draw_old(old_display_1, frame, FRAME_WIDTH, FRAME_HEIGHT);
+        draw_old(old_display_2, player_frame, PLAYER_WIDTH, PLAYER_HEIGHT);
+    });
+    benchmark("canvas_write_strip", 1000, [](uint16_t){
+        frame.write_strip(display_1_map, display_1.getPixels(), BRIGHTNESS);
+        player_frame.write_strip(display_2_map, display_2.getPixels(), BRIGHTNESS);
+    });
+    TEST_ASSERT_EQUAL_MEMORY(old_matrix_1.strip.getPixels(), display_1.getPixels(),
+        FRAME_WIDTH * FRAME_HEIGHT * 3);
+}
+
+int main(){
+    UNITY_BEGIN();
+    benchmark_header();
+    RUN_TEST(test_maps);
+    RUN_TEST(test_same_as_old);
+    RUN_TEST(test_write_strip_speed);
+    return UNITY_END();
+}
@@ -0,0 +1,278 @@
+/**
+ * Persistent Storage Tests for Battlebricks Timer
+ * Cuts the power at every byte of a write, on the host, and checks that the pairs read back
+ * afterwards are all from before or after a change, never a mix or garbage. Runs against the
+ * JSON file in [env:native] and against the log in [env:native_log]. Also times an update
+ * (set() and flush()), printed in the CSV format of src/benchmark.h with -v.
+ *
+ * Storage objects stay linked into the list that flush_all() writes, so they're never
+ * deleted. Each one is new, so it loads its file again, like after a restart.
+ **/
+#include <unity.h>
+#include "Arduino.h"
+#include "Native.h"
+#include "benchmark.h"
+#include "Storage.h"
+#include "Persistent_Storage.h"
+
+#include <vector>
+
+#define NUM_KEYS 3
+
+const char* keys[NUM_KEYS] = {"total_time", "mode", "brightness"};
+
+// Changes made one flush at a time, NULL removes the key
+struct Change{
+    uint8_t key;
+    const char* value;
+};
+
+const Change changes[] = {
+    {0, "180"}, {1, "1"}, {2, "2"}, {0, "150"}, {1, NULL}, {2, "3"}, {1, "2"}, {0, ""}
+};
+#define NUM_CHANGES (sizeof(changes) / sizeof(changes[0]))
+
+// Values of every key after each number of changes ("" if missing)
+String expected[NUM_CHANGES + 1][NUM_KEYS];
+
+// Size of the file after each number of changes (bytes)
+size_t boundary[NUM_CHANGES + 1];
+
+Persistent_Storage* bench_storage;
+
+void setUp(){}
+void tearDown(){}
+
+/**
+ * @param path of a file
+ * @return its contents
+ **/
+std::vector<uint8_t> read_file(const char* path){
+    std::vector<uint8_t> data;
+    File file = storage.open(path, "r");
+    if(!file) return data;
+    data.resize(file.size());
+    file.read(data.data(), data.size());
+    file.close();
+    return data;
+}
+
+/**
+ * @param path of the file to replace
+ * @param data contents
+ * @param length bytes of data to write
+ **/
+void write_file(const char* path, const uint8_t* data, size_t length){
+    File file = storage.open(path, "w");
+    file.write(data, length);
+    file.close();
+}
+
+/**
+ * Make every change, flushing after each one, and note what the file holds in between
+ * @param name of the storage object
+ * @return contents of the file after all of them
+ **/
+std::vector<uint8_t> make_changes(const char* name){
+#ifdef PERSISTENT_STORAGE_LOG
+    String path = "/" + String(name) + ".log";
+#else
+    String path = "/" + String(name) + ".txt";
+#endif
+    storage.remove(path);
+    Persistent_Storage* store = new Persistent_Storage(name);
+    String values[NUM_KEYS];
+    for(uint8_t i = 0; i <= NUM_CHANGES; i++){
+        if(i > 0){
+            const Change& change = changes[i - 1];
+            if(change.value) store->set(keys[change.key], change.value);
+            else store->remove(keys[change.key]);
+            TEST_ASSERT_TRUE(store->flush());
+            values[change.key] = change.value ? change.value : "";
+        }
+        for(uint8_t k = 0; k < NUM_KEYS; k++) expected[i][k] = values[k];
+        boundary[i] = read_file(path.c_str()).size();
+    }
+    return read_file(path.c_str());
+}
+
+/**
+ * Check that a storage object holds the values from after a number of changes
+ * @param store to check
+ * @param done number of changes
+ * @param offset where the file was cut, for the failure message
+ **/
+void check_values(Persistent_Storage* store, uint8_t done, size_t offset){
+    char message[48];
+    for(uint8_t k = 0; k < NUM_KEYS; k++){
+        snprintf(message, sizeof(message), "%s, cut at byte %u", keys[k], (unsigned)offset);
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(expected[done][k].c_str(), store->get(keys[k]).c_str(),
+            message);
+    }
+}
+
+#ifdef PERSISTENT_STORAGE_LOG
+
+#define TORN_TRUNCATED 0 //The file ends where the power was cut
+#define TORN_ERASED 1 //The rest of the record is still erased flash
+#define TORN_GARBAGE 2 //The rest of the record is half-programmed
+
+/**
+ * Cut the log at every byte and load it, then check that it's repaired: the complete records
+ * are kept, and a change made afterwards survives another restart
+ * @param torn what the bytes after the cut look like
+ **/
+void check_torn_log(uint8_t torn){
+    std::vector<uint8_t> log = make_changes("power");
+    TEST_ASSERT_EQUAL(boundary[NUM_CHANGES], log.size());
+
+    uint32_t seed = 1;
+    for(size_t offset = 0; offset <= log.size(); offset++){
+        std::vector<uint8_t> data(log.begin(), log.begin() + offset);
+        if(torn != TORN_TRUNCATED){
+            for(size_t i = offset; i < log.size(); i++){
+                seed = seed * 1103515245 + 12345;
+                data.push_back(torn == TORN_ERASED ? 0xFF : seed >> 16);
+            }
+        }
+        write_file("/torn.log", data.data(), data.size());
+
+        // The changes whose records are complete
+        uint8_t done = 0;
+        while(done < NUM_CHANGES && boundary[done + 1] <= offset) done++;
+        bool damaged = data.size() != boundary[done];
+
+        uint32_t recoveries = Persistent_Storage::get_recoveries();
+        Persistent_Storage* store = new Persistent_Storage("torn");
+        check_values(store, done, offset);
+        TEST_ASSERT_EQUAL(recoveries + damaged, Persistent_Storage::get_recoveries());
+
+        // Records appended after the repair are read back
+        store->set("after", String((unsigned)offset));
+        TEST_ASSERT_TRUE(store->flush());
+        store = new Persistent_Storage("torn");
+        check_values(store, done, offset);
+        TEST_ASSERT_TRUE(store->get("after") == String((unsigned)offset));
+        TEST_ASSERT_EQUAL(recoveries + damaged, Persistent_Storage::get_recoveries());
+    }
+}
+
+void test_log_truncated(){
+    check_torn_log(TORN_TRUNCATED);
+}
+
+void test_log_erased(){
+    check_torn_log(TORN_ERASED);
+}
+
+void test_log_garbage(){
+    check_torn_log(TORN_GARBAGE);
+}
+
+/**
+ * A compaction cut off before its rename leaves the old log and part of the new one
+ **/
+void test_log_compact_cut(){
+    std::vector<uint8_t> log = make_changes("power");
+    for(size_t offset = 0; offset <= log.size(); offset++){
+        write_file("/torn.log", log.data(), log.size());
+        write_file("/torn.log.tmp", log.data(), offset);
+        Persistent_Storage* store = new Persistent_Storage("torn");
+        check_values(store, NUM_CHANGES, offset);
+        TEST_ASSERT_FALSE(storage.exists("/torn.log.tmp"));
+    }
+}
+
+/**
+ * Moving the pairs from the JSON file into the first log is cut off before its rename: the
+ * JSON file is still there and no log, so the move is made again
+ **/
+void test_log_migration_cut(){
+    std::vector<uint8_t> log = make_changes("power");
+    const char json[] = "{\"total_time\":\"150\",\"brightness\":\"3\",\"mode\":\"2\"}";
+    for(size_t offset = 0; offset <= log.size(); offset++){
+        storage.remove("/torn.log");
+        write_file("/torn.txt", (const uint8_t*)json, strlen(json));
+        write_file("/torn.log.tmp", log.data(), offset);
+        Persistent_Storage* store = new Persistent_Storage("torn");
+        check_values(store, NUM_CHANGES - 1, offset);
+        TEST_ASSERT_FALSE(storage.exists("/torn.log.tmp"));
+        TEST_ASSERT_FALSE(storage.exists("/torn.txt"));
+
+        // The log it was moved into is read after another restart
+        store = new Persistent_Storage("torn");
+        check_values(store, NUM_CHANGES - 1, offset);
+    }
+}
+
+#else
+
+/**
+ * Cut the temporary file at every byte with the old file still there: the old pairs are
+ * kept and the temporary file is removed
+ **/
+void test_json_temp_cut(){
+    std::vector<uint8_t> json = make_changes("power");
+    Persistent_Storage* before = new Persistent_Storage("power");
+    before->set(keys[0], "999");
+    TEST_ASSERT_TRUE(before->flush());
+    std::vector<uint8_t> next = read_file("/power.txt");
+
+    for(size_t offset = 0; offset <= next.size(); offset++){
+        write_file("/torn.txt", json.data(), json.size());
+        write_file("/torn.txt.tmp", next.data(), offset);
+        uint32_t recoveries = Persistent_Storage::get_recoveries();
+        Persistent_Storage* store = new Persistent_Storage("torn");
+        check_values(store, NUM_CHANGES, offset);
+        TEST_ASSERT_FALSE(storage.exists("/torn.txt.tmp"));
+        TEST_ASSERT_EQUAL(recoveries, Persistent_Storage::get_recoveries());
+    }
+}
+
+/**
+ * Cut the power between removing the old file and renaming the new one: the new one is used
+ **/
+void test_json_temp_recovered(){
+    std::vector<uint8_t> json = make_changes("power");
+    storage.remove("/torn.txt");
+    write_file("/torn.txt.tmp", json.data(), json.size());
+    uint32_t recoveries = Persistent_Storage::get_recoveries();
+    Persistent_Storage* store = new Persistent_Storage("torn");
+    check_values(store, NUM_CHANGES, json.size());
+    TEST_ASSERT_TRUE(storage.exists("/torn.txt"));
+    TEST_ASSERT_FALSE(storage.exists("/torn.txt.tmp"));
+    TEST_ASSERT_EQUAL(recoveries + 1, Persistent_Storage::get_recoveries());
+}
+
+#endif
+
+void test_update_latency(){
+    uint32_t written = Persistent_Storage::get_bytes_written();
+    benchmark("storage_update", 200, [](uint16_t i){
+        bench_storage->set("key", String(i));
+        bench_storage->flush();
+    });
+    benchmark_count("storage_update", 200, "bytes_written",
+        Persistent_Storage::get_bytes_written() - written);
+    benchmark("storage_reload", 200, [](uint16_t){ (new Persistent_Storage("bench"))->get("key"); });
+    TEST_ASSERT_TRUE((new Persistent_Storage("bench"))->get("key") == "199");
+}
+
+int main(){
+    bench_storage = new Persistent_Storage("bench");
+
+    UNITY_BEGIN();
+    benchmark_header();
+#ifdef PERSISTENT_STORAGE_LOG
+    RUN_TEST(test_log_truncated);
+    RUN_TEST(test_log_erased);
+    RUN_TEST(test_log_garbage);
+    RUN_TEST(test_log_compact_cut);
+    RUN_TEST(test_log_migration_cut);
+#else
+    RUN_TEST(test_json_temp_cut);
+    RUN_TEST(test_json_temp_recovered);
+#endif
+    RUN_TEST(test_update_latency);
+    return UNITY_END();
+}
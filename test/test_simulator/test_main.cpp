@@ -0,0 +1,83 @@
+/**
+ * Simulator Tests for Battlebricks Timer
+ * Boots the timer on the host, then plays random matches in virtual time (see 
+ * src/simulator.h). Every match must reach game over having counted down for the match time.
+ * Also taps a button while the loop is stalled, which only the button's edge queue sees.
+ **/
+#include <unity.h>
+#include "Arduino.h"
+#include "Native.h"
+#include "simulator.h"
+#include "states.h"
+#include "Clock.h"
+#include "Button.h"
+
+// Defined in battlebricks.cpp
+extern uint8_t state;
+extern bool blue_ready;
+extern Button btn_blue;
+void reset();
+
+void setUp(){}
+void tearDown(){}
+
+/**
+ * Run the loop for a while
+ * @param time to run for (ms)
+ **/
+void run_loop(uint32_t time){
+    uint32_t start = clock_millis();
+    while(clock_millis() - start < time){
+        loop();
+        clock_advance(1);
+    }
+}
+
+/**
+ * Reset to standby, then tap blue while the loop is stalled
+ * @param stall length of the stall (ms)
+ * @param hold how long the tap is held, starting 30ms into the stall (ms)
+ * @return true if the tap made blue ready
+ **/
+bool stalled_tap(uint32_t stall, uint32_t hold){
+    reset();
+    run_loop(100);
+    TEST_ASSERT_EQUAL_UINT8(STANDBY, state);
+    TEST_ASSERT_FALSE(blue_ready);
+
+    clock_advance(30);
+    btn_blue.inject(true);
+    clock_advance(hold);
+    btn_blue.inject(false);
+    clock_advance(stall - 30 - hold);
+    run_loop(100);
+    return blue_ready;
+}
+
+void test_tap_during_stall(){
+    TEST_ASSERT_TRUE(stalled_tap(100, 30));
+    TEST_ASSERT_TRUE(btn_blue.get_release_time() - btn_blue.get_press_time() == 30000);
+    TEST_ASSERT_FALSE(btn_blue.get());
+}
+
+void test_glitch_during_stall(){
+    // Shorter than the debounce time, so it's noise
+    TEST_ASSERT_FALSE(stalled_tap(100, 3));
+}
+
+void test_random_matches(){
+    for(uint32_t seed = 1; seed <= 4; seed++){
+        TEST_ASSERT_EQUAL_UINT16(0, run_simulation(seed, 25));
+    }
+}
+
+int main(){
+    native_fs_load("data");
+    setup();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_tap_during_stall);
+    RUN_TEST(test_glitch_during_stall);
+    RUN_TEST(test_random_matches);
+    return UNITY_END();
+}
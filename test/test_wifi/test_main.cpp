@@ -0,0 +1,68 @@
+/**
+ * WiFi Tests for Battlebricks Timer
+ * Boots the timer on the host with the default settings: WiFi must stay off during play, so 
+ * the hotspot and its settings page can't be reached mid-match. The match journal has to be
+ * read in WiFi setup mode instead, so it must survive the restart into it.
+ **/
+#include <unity.h>
+#include "Arduino.h"
+#include "Native.h"
+#include "ESP8266WiFi.h"
+#include "config.h"
+#include "journal.h"
+#include "Web_Interface.h"
+
+// Defined in battlebricks.cpp
+extern bool wifi_on;
+extern Config config;
+extern Web_Interface webinterface;
+
+// Defined in journal.cpp
+extern Journal_Ring journal;
+
+void setUp(){}
+void tearDown(){}
+
+void test_wifi_off_during_play(){
+    // The settings file was read
+    TEST_ASSERT_TRUE(config.hotspot_ssid == "battlebricks");
+    TEST_ASSERT_FALSE(config.wifi_during_play);
+    TEST_ASSERT_FALSE(wifi_on);
+    TEST_ASSERT_EQUAL(WIFI_OFF, WiFi.getMode());
+    TEST_ASSERT_TRUE(WiFi.softAPSSID() == "");
+}
+
+void test_journal_kept_across_restart(){
+    // The boot event
+    TEST_ASSERT_EQUAL(1, journal.count);
+    journal_record(JOURNAL_PRESS, JOURNAL_BLUE, 1, 0, 1000);
+    // A restart runs journal_begin() again without clearing the RAM
+    journal_begin(webinterface);
+    TEST_ASSERT_EQUAL(2, journal.count);
+    TEST_ASSERT_EQUAL(JOURNAL_PRESS, journal.entries[1].type);
+    TEST_ASSERT_EQUAL(1000, journal.entries[1].time);
+}
+
+void test_journal_cleared_after_power_up(){
+    // Whatever the RAM came up with
+    memset(&journal, 0x5A, sizeof(journal));
+    journal_begin(webinterface);
+    TEST_ASSERT_EQUAL(0, journal.count);
+
+    // Intact apart from an entry whose name can't be looked up
+    journal_record(JOURNAL_BOOT, JOURNAL_NONE, 0, 0, 0);
+    journal.entries[JOURNAL_SIZE - 1].type = JOURNAL_TYPES;
+    journal_begin(webinterface);
+    TEST_ASSERT_EQUAL(0, journal.count);
+}
+
+int main(){
+    native_fs_load("data");
+    setup();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_wifi_off_during_play);
+    RUN_TEST(test_journal_kept_across_restart);
+    RUN_TEST(test_journal_cleared_after_power_up);
+    return UNITY_END();
+}